@@ -123,7 +123,9 @@ IdArray Relabel_(const std::vector<IdArray>& arrays);
 /*!
  * \brief Plain CSR matrix
  *
- * The column indices are 0-based and are not necessarily sorted.
+ * The column indices are 0-based and are not necessarily sorted. If the
+ * sorted flag is set, the column indices of every row are known to be in
+ * increasing order, which lets the lookup routines use binary search.
  *
  * Note that we do allow duplicate non-zero entries -- multiple non-zero entries
  * that have the same row, col indices. It corresponds to multigraph in
@@ -131,11 +133,25 @@ IdArray Relabel_(const std::vector<IdArray>& arrays);
  */
 struct CSRMatrix {
   /*! \brief the dense shape of the matrix */
-  int64_t num_rows, num_cols;
+  int64_t num_rows = 0, num_cols = 0;
   /*! \brief CSR index arrays */
   runtime::NDArray indptr, indices;
-  /*! \brief data array, could be empty. */
+  /*!
+   * \brief data array, could be empty.
+   *
+   * An empty data array means the data of each entry is its position in
+   * the indices array (i.e., data[i] == i). The CSR routines below treat
+   * it so, and return data arrays of the index type in that case.
+   */
   runtime::NDArray data;
+  /*! \brief whether the column indices of each row are sorted; false if unknown */
+  bool sorted = false;
+
+  CSRMatrix() = default;
+  CSRMatrix(int64_t nrows, int64_t ncols, runtime::NDArray parr, runtime::NDArray iarr,
+            runtime::NDArray darr = runtime::NDArray(), bool sorted_flag = false)
+    : num_rows(nrows), num_cols(ncols), indptr(parr), indices(iarr), data(darr),
+      sorted(sorted_flag) {}
 };
 
 /*!
@@ -152,16 +168,25 @@ struct COOMatrix {
   int64_t num_rows, num_cols;
   /*! \brief COO index arrays */
   runtime::NDArray row, col;
-  /*! \brief data array, could be empty. */
+  /*! \brief data array, could be empty (i.e., data[i] == i). */
   runtime::NDArray data;
 };
 
 ///////////////////////// CSR routines //////////////////////////
 
+/*! \return True if the matrix has an explicit data array */
+inline bool CSRHasData(CSRMatrix csr) {
+  return csr.data.defined();
+}
+
 /*! \brief Return true if the value (row, col) is non-zero */
 bool CSRIsNonZero(CSRMatrix , int64_t row, int64_t col);
 /*!
  * \brief Batched implementation of CSRIsNonZero.
+ *
+ * The queries are processed in parallel. The rows are binary searched if
+ * the matrix is sorted.
+ *
  * \note This operator allows broadcasting (i.e, either row or col can be of length 1).
  */
 runtime::NDArray CSRIsNonZero(CSRMatrix, runtime::NDArray row, runtime::NDArray col);
@@ -180,13 +205,21 @@ runtime::NDArray CSRGetRowData(CSRMatrix , int64_t row);
 runtime::NDArray CSRGetData(CSRMatrix , int64_t row, int64_t col);
 /*!
  * \brief Batched implementation of CSRGetData.
+ *
+ * The queries are processed in parallel. The rows are binary searched if
+ * the matrix is sorted.
+ *
  * \note This operator allows broadcasting (i.e, either row or col can be of length 1).
  */
-
 runtime::NDArray CSRGetData(CSRMatrix, runtime::NDArray rows, runtime::NDArray cols);
 
 /*!
  * \brief Get the data and the row,col indices for each returned entries.
+ *
+ * The entries are returned in the order of the queries, and in the order of
+ * the matrix for the duplicate entries of a query. The queries are processed
+ * in parallel. The rows are binary searched if the matrix is sorted.
+ *
  * \note This operator allows broadcasting (i.e, either row or col can be of length 1).
  */
 std::vector<runtime::NDArray> CSRGetDataAndIndices(
@@ -244,8 +277,16 @@ CSRMatrix CSRSliceMatrix(CSRMatrix csr, runtime::NDArray rows, runtime::NDArray
 /*! \return True if the matrix has duplicate entries */
 bool CSRHasDuplicate(CSRMatrix csr);
 
+/*! \return True if the column indices of each row are in increasing order */
+bool CSRIsSorted(CSRMatrix csr);
+
 ///////////////////////// COO routines //////////////////////////
 
+/*! \return True if the matrix has an explicit data array */
+inline bool COOHasData(COOMatrix coo) {
+  return coo.data.defined();
+}
+
 /*! \return True if the matrix has duplicate entries */
 bool COOHasDuplicate(COOMatrix coo);
 
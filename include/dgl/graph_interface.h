@@ -10,6 +10,7 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <memory>
 
 #include "./runtime/object.h"
 #include "array.h"
@@ -22,7 +23,9 @@ const dgl_id_t DGL_INVALID_ID = static_cast<dgl_id_t>(-1);
  * \brief This class references data in std::vector.
  *
  * This isn't a STL-style iterator. It provides a STL data container interface.
- * but it doesn't own data itself. instead, it only references data in std::vector.
+ * but it usually doesn't own data itself. instead, it only references data in std::vector.
+ * Graphs that have to decode the ids on the fly (e.g., compressed CSR) hand over
+ * the decoded buffer, which is then kept alive by the iterator.
  */
 class DGLIdIters {
  public:
@@ -33,6 +36,9 @@ class DGLIdIters {
     this->begin_ = begin;
     this->end_ = end;
   }
+  /* !\brief constructor that takes the ownership of the given ids */
+  explicit DGLIdIters(std::shared_ptr<std::vector<dgl_id_t>> data)
+    : begin_(data->data()), end_(data->data() + data->size()), data_(data) {}
   const dgl_id_t *begin() const {
     return this->begin_;
   }
@@ -47,6 +53,8 @@ class DGLIdIters {
   }
  private:
   const dgl_id_t *begin_{nullptr}, *end_{nullptr};
+  // the ids if they are owned by this object
+  std::shared_ptr<std::vector<dgl_id_t>> data_;
 };
 
 /* \brief structure used to represent a list of edges */
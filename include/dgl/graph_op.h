@@ -6,6 +6,8 @@
 #ifndef DGL_GRAPH_OP_H_
 #define DGL_GRAPH_OP_H_
 
+#include <string>
+#include <utility>
 #include <vector>
 #include "graph.h"
 #include "immutable_graph.h"
@@ -139,6 +141,44 @@ class GraphOp {
    * \return a new immutable bidirected graph.
    */
   static GraphPtr ToBidirectedImmutableGraph(GraphPtr graph);
+
+  /*!
+   * \brief Compute a locality-aware order of the vertices.
+   *
+   * The edges are seen as undirected. The supported methods are:
+   * - "degree": by decreasing degree, so that the hub vertices are adjacent.
+   * - "rcm": reverse Cuthill-McKee, which reduces the bandwidth of the adjacency
+   *   matrix so that the neighbors of a vertex have close ids.
+   * - "gorder": Gorder, which greedily places together the vertices that share
+   *   many neighbors within a sliding window.
+   *
+   * \param graph The input graph on CPU.
+   * \param method The ordering method.
+   * \param window The window size of "gorder".
+   * \return The permutation perm, where perm[i] is the old id of the vertex
+   *         whose new id is i.
+   */
+  static IdArray VertexOrder(GraphPtr graph, const std::string &method, int64_t window = 5);
+
+  /*!
+   * \brief Relabel the vertices of a graph.
+   *
+   * The edges keep their ids, so edge features do not need to be permuted.
+   * Node features are permuted by gathering the rows in perm.
+   *
+   * \param graph The input graph on CPU.
+   * \param perm The permutation, where perm[i] is the old id of the vertex whose
+   *        new id is i.
+   * \return The relabeled immutable graph.
+   */
+  static ImmutableGraphPtr PermuteVertices(GraphPtr graph, IdArray perm);
+
+  /*!
+   * \brief Relabel the vertices of a graph in the order computed by VertexOrder.
+   * \return The relabeled immutable graph and the permutation.
+   */
+  static std::pair<ImmutableGraphPtr, IdArray> ReorderVertices(
+      GraphPtr graph, const std::string &method, int64_t window = 5);
 };
 
 }  // namespace dgl
@@ -12,6 +12,8 @@
 #include <utility>
 #include <tuple>
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include "runtime/ndarray.h"
 #include "graph_interface.h"
 #include "lazy.h"
@@ -23,6 +25,9 @@ class COO;
 typedef std::shared_ptr<CSR> CSRPtr;
 typedef std::shared_ptr<COO> COOPtr;
 
+class CompressedCSR;
+typedef std::shared_ptr<CompressedCSR> CompressedCSRPtr;
+
 class ImmutableGraph;
 typedef std::shared_ptr<ImmutableGraph> ImmutableGraphPtr;
 
@@ -39,6 +44,8 @@ class CSR : public GraphInterface {
       int64_t num_vertices, int64_t num_edges, bool is_multigraph);
 
   // Create a csr graph that shares the given indptr and indices.
+  //   An undefined edge_ids array means the edge ids are 0, 1, ..., nnz - 1
+  //   in CSR order.
   CSR(IdArray indptr, IdArray indices, IdArray edge_ids);
   CSR(IdArray indptr, IdArray indices, IdArray edge_ids, bool is_multigraph);
 
@@ -81,6 +88,12 @@ class CSR : public GraphInterface {
 
   bool IsMultigraph() const override;
 
+  /*!
+   * \return whether the neighbors of every vertex are sorted. The result is
+   *         computed on the first call and cached.
+   */
+  bool IsSorted() const;
+
   bool IsReadonly() const override {
     return true;
   }
@@ -188,7 +201,7 @@ class CSR : public GraphInterface {
 
   std::vector<IdArray> GetAdj(bool transpose, const std::string &fmt) const override {
     CHECK(!transpose && fmt == "csr") << "Not valid adj format request.";
-    return {adj_.indptr, adj_.indices, adj_.data};
+    return {adj_.indptr, adj_.indices, edge_ids_or_range()};
   }
 
   /*! \brief Indicate whether this uses shared memory. */
@@ -196,6 +209,14 @@ class CSR : public GraphInterface {
     return !shared_mem_name_.empty();
   }
 
+  /*!
+   * \brief Indicate whether the arrays are backed by a read-only file mapping,
+   *        as the ones of ImmutableGraph::Load. They must not be modified.
+   */
+  bool IsMapped() const {
+    return mapped_;
+  }
+
   /*! \brief Return the reverse of this CSR graph (i.e, a CSC graph) */
   CSRPtr Transpose() const;
 
@@ -238,8 +259,18 @@ class CSR : public GraphInterface {
 
   IdArray indices() const { return adj_.indices; }
 
+  /*!
+   * \return the edge id array; undefined if the edge id of each edge is its
+   *         position in the indices array.
+   */
   IdArray edge_ids() const { return adj_.data; }
 
+  /*! \return the edge id array, materialized if the edge ids are implicit */
+  IdArray edge_ids_or_range() const {
+    return aten::CSRHasData(adj_) ? adj_.data
+      : aten::Range(0, NumEdges(), NumBits(), Context());
+  }
+
  private:
   /*! \brief prive default constructor */
   CSR() {}
@@ -251,9 +282,17 @@ class CSR : public GraphInterface {
   // whether the graph is a multi-graph
   Lazy<bool> is_multigraph_;
 
+  // whether the neighbors of every vertex are sorted
+  Lazy<bool> is_sorted_;
+
   // The name of the shared memory to store data.
   // If it's empty, data isn't stored in shared memory.
   std::string shared_mem_name_;
+
+  // whether the arrays are backed by a read-only file mapping
+  bool mapped_ = false;
+
+  friend class ImmutableGraph;
 };
 
 class COO : public GraphInterface {
@@ -507,6 +546,17 @@ class COO : public GraphInterface {
  * \brief DGL immutable graph index class.
  *
  * DGL's graph is directed. Vertices are integers enumerated from zero.
+ *
+ * The graph stores up to three formats (in-CSR, out-CSR and COO) and builds
+ * the missing ones on demand. Building is thread-safe and happens at most once
+ * per format: concurrent callers of GetInCSR/GetOutCSR/GetCOO wait for the
+ * one that builds it. Use Materialize to build formats ahead of time.
+ *
+ * A graph created by Compress keeps both CSRs in compressed form instead.
+ * Counting queries, per-vertex queries (SuccVec, PredVec, OutEdges, etc.) and
+ * neighbor and layer sampling decode the compressed rows on the fly. Other
+ * operators decompress the format they need on every call; use Materialize to
+ * keep an uncompressed format instead.
  */
 class ImmutableGraph: public GraphInterface {
  public:
@@ -534,25 +584,41 @@ class ImmutableGraph: public GraphInterface {
   /*! \brief Construct an immutable graph from one CSR. */
   explicit ImmutableGraph(CSRPtr csr): out_csr_(csr) { }
 
-  /*! \brief default copy constructor */
-  ImmutableGraph(const ImmutableGraph& other) = default;
+  /*! \brief Construct an immutable graph from compressed CSRs. */
+  ImmutableGraph(CompressedCSRPtr in_csr, CompressedCSRPtr out_csr)
+    : compressed_in_csr_(in_csr), compressed_out_csr_(out_csr) {
+    CHECK(compressed_in_csr_ && compressed_out_csr_) << "Both compressed CSRs are required.";
+  }
+
+  /*! \brief copy constructor */
+  ImmutableGraph(const ImmutableGraph& other)
+    : in_csr_(other.CurrentInCSR()), out_csr_(other.CurrentOutCSR()),
+      coo_(other.CurrentCOO()), compressed_in_csr_(other.compressed_in_csr_),
+      compressed_out_csr_(other.compressed_out_csr_),
+      shared_mem_name_(other.shared_mem_name_) {}
 
-#ifndef _MSC_VER
-  /*! \brief default move constructor */
-  ImmutableGraph(ImmutableGraph&& other) = default;
-#else
+  /*! \brief move constructor */
   ImmutableGraph(ImmutableGraph&& other) {
-    this->in_csr_ = other.in_csr_;
-    this->out_csr_ = other.out_csr_;
-    this->coo_ = other.coo_;
-    other.in_csr_ = nullptr;
-    other.out_csr_ = nullptr;
-    other.coo_ = nullptr;
+    this->in_csr_ = std::move(other.in_csr_);
+    this->out_csr_ = std::move(other.out_csr_);
+    this->coo_ = std::move(other.coo_);
+    this->compressed_in_csr_ = std::move(other.compressed_in_csr_);
+    this->compressed_out_csr_ = std::move(other.compressed_out_csr_);
+    this->shared_mem_name_ = std::move(other.shared_mem_name_);
+  }
+
+  /*! \brief assign constructor */
+  ImmutableGraph& operator=(const ImmutableGraph& other) {
+    if (this != &other) {
+      std::atomic_store(&in_csr_, other.CurrentInCSR());
+      std::atomic_store(&out_csr_, other.CurrentOutCSR());
+      std::atomic_store(&coo_, other.CurrentCOO());
+      compressed_in_csr_ = other.compressed_in_csr_;
+      compressed_out_csr_ = other.compressed_out_csr_;
+      shared_mem_name_ = other.shared_mem_name_;
+    }
+    return *this;
   }
-#endif  // _MSC_VER
-
-  /*! \brief default assign constructor */
-  ImmutableGraph& operator=(const ImmutableGraph& other) = default;
 
   /*! \brief default destructor */
   ~ImmutableGraph() = default;
@@ -573,21 +639,15 @@ class ImmutableGraph: public GraphInterface {
     LOG(FATAL) << "Clear isn't supported in ImmutableGraph";
   }
 
-  DLContext Context() const override {
-    return AnyGraph()->Context();
-  }
+  DLContext Context() const override;
 
-  uint8_t NumBits() const override {
-    return AnyGraph()->NumBits();
-  }
+  uint8_t NumBits() const override;
 
   /*!
    * \note not const since we have caches
    * \return whether the graph is a multigraph
    */
-  bool IsMultigraph() const override {
-    return AnyGraph()->IsMultigraph();
-  }
+  bool IsMultigraph() const override;
 
   /*!
    * \return whether the graph is read-only
@@ -597,14 +657,10 @@ class ImmutableGraph: public GraphInterface {
   }
 
   /*! \return the number of vertices in the graph.*/
-  uint64_t NumVertices() const override {
-    return AnyGraph()->NumVertices();
-  }
+  uint64_t NumVertices() const override;
 
   /*! \return the number of edges in the graph.*/
-  uint64_t NumEdges() const override {
-    return AnyGraph()->NumEdges();
-  }
+  uint64_t NumEdges() const override;
 
   /*! \return true if the given vertex is in the graph.*/
   bool HasVertex(dgl_id_t vid) const override {
@@ -614,17 +670,12 @@ class ImmutableGraph: public GraphInterface {
   BoolArray HasVertices(IdArray vids) const override;
 
   /*! \return true if the given edge is in the graph.*/
-  bool HasEdgeBetween(dgl_id_t src, dgl_id_t dst) const override {
-    if (in_csr_) {
-      return in_csr_->HasEdgeBetween(dst, src);
-    } else {
-      return GetOutCSR()->HasEdgeBetween(src, dst);
-    }
-  }
+  bool HasEdgeBetween(dgl_id_t src, dgl_id_t dst) const override;
 
   BoolArray HasEdgesBetween(IdArray src, IdArray dst) const override {
-    if (in_csr_) {
-      return in_csr_->HasEdgesBetween(dst, src);
+    const CSRPtr in_csr = CurrentInCSR();
+    if (in_csr) {
+      return in_csr->HasEdgesBetween(dst, src);
     } else {
       return GetOutCSR()->HasEdgesBetween(src, dst);
     }
@@ -636,9 +687,7 @@ class ImmutableGraph: public GraphInterface {
    * \param radius The radius of the neighborhood. Default is immediate neighbor (radius=1).
    * \return the predecessor id array.
    */
-  IdArray Predecessors(dgl_id_t vid, uint64_t radius = 1) const override {
-    return GetInCSR()->Successors(vid, radius);
-  }
+  IdArray Predecessors(dgl_id_t vid, uint64_t radius = 1) const override;
 
   /*!
    * \brief Find the successors of a vertex.
@@ -646,9 +695,7 @@ class ImmutableGraph: public GraphInterface {
    * \param radius The radius of the neighborhood. Default is immediate neighbor (radius=1).
    * \return the successor id array.
    */
-  IdArray Successors(dgl_id_t vid, uint64_t radius = 1) const override {
-    return GetOutCSR()->Successors(vid, radius);
-  }
+  IdArray Successors(dgl_id_t vid, uint64_t radius = 1) const override;
 
   /*!
    * \brief Get all edge ids between the two given endpoints
@@ -658,13 +705,7 @@ class ImmutableGraph: public GraphInterface {
    * \param dst The destination vertex.
    * \return the edge id array.
    */
-  IdArray EdgeId(dgl_id_t src, dgl_id_t dst) const override {
-    if (in_csr_) {
-      return in_csr_->EdgeId(dst, src);
-    } else {
-      return GetOutCSR()->EdgeId(src, dst);
-    }
-  }
+  IdArray EdgeId(dgl_id_t src, dgl_id_t dst) const override;
 
   /*!
    * \brief Get all edge ids between the given endpoint pairs.
@@ -676,8 +717,9 @@ class ImmutableGraph: public GraphInterface {
    * \return EdgeArray containing all edges between all pairs.
    */
   EdgeArray EdgeIds(IdArray src, IdArray dst) const override {
-    if (in_csr_) {
-      EdgeArray edges = in_csr_->EdgeIds(dst, src);
+    const CSRPtr in_csr = CurrentInCSR();
+    if (in_csr) {
+      EdgeArray edges = in_csr->EdgeIds(dst, src);
       return EdgeArray{edges.dst, edges.src, edges.id};
     } else {
       return GetOutCSR()->EdgeIds(src, dst);
@@ -708,10 +750,7 @@ class ImmutableGraph: public GraphInterface {
    * \param vid The vertex id.
    * \return the edges
    */
-  EdgeArray InEdges(dgl_id_t vid) const override {
-    const EdgeArray& ret = GetInCSR()->OutEdges(vid);
-    return {ret.dst, ret.src, ret.id};
-  }
+  EdgeArray InEdges(dgl_id_t vid) const override;
 
   /*!
    * \brief Get the in edges of the vertices.
@@ -729,9 +768,7 @@ class ImmutableGraph: public GraphInterface {
    * \param vid The vertex id.
    * \return the id arrays of the two endpoints of the edges.
    */
-  EdgeArray OutEdges(dgl_id_t vid) const override {
-    return GetOutCSR()->OutEdges(vid);
-  }
+  EdgeArray OutEdges(dgl_id_t vid) const override;
 
   /*!
    * \brief Get the out edges of the vertices.
@@ -756,36 +793,28 @@ class ImmutableGraph: public GraphInterface {
    * \param vid The vertex id.
    * \return the in degree
    */
-  uint64_t InDegree(dgl_id_t vid) const override {
-    return GetInCSR()->OutDegree(vid);
-  }
+  uint64_t InDegree(dgl_id_t vid) const override;
 
   /*!
    * \brief Get the in degrees of the given vertices.
    * \param vid The vertex id array.
    * \return the in degree array
    */
-  DegreeArray InDegrees(IdArray vids) const override {
-    return GetInCSR()->OutDegrees(vids);
-  }
+  DegreeArray InDegrees(IdArray vids) const override;
 
   /*!
    * \brief Get the out degree of the given vertex.
    * \param vid The vertex id.
    * \return the out degree
    */
-  uint64_t OutDegree(dgl_id_t vid) const override {
-    return GetOutCSR()->OutDegree(vid);
-  }
+  uint64_t OutDegree(dgl_id_t vid) const override;
 
   /*!
    * \brief Get the out degrees of the given vertices.
    * \param vid The vertex id array.
    * \return the out degree array
    */
-  DegreeArray OutDegrees(IdArray vids) const override {
-    return GetOutCSR()->OutDegrees(vids);
-  }
+  DegreeArray OutDegrees(IdArray vids) const override;
 
   /*!
    * \brief Construct the induced subgraph of the given vertices.
@@ -828,36 +857,28 @@ class ImmutableGraph: public GraphInterface {
    * \param vid The vertex id.
    * \return the successor vector
    */
-  DGLIdIters SuccVec(dgl_id_t vid) const override {
-    return GetOutCSR()->SuccVec(vid);
-  }
+  DGLIdIters SuccVec(dgl_id_t vid) const override;
 
   /*!
    * \brief Return the out edge id vector
    * \param vid The vertex id.
    * \return the out edge id vector
    */
-  DGLIdIters OutEdgeVec(dgl_id_t vid) const override {
-    return GetOutCSR()->OutEdgeVec(vid);
-  }
+  DGLIdIters OutEdgeVec(dgl_id_t vid) const override;
 
   /*!
    * \brief Return the predecessor vector
    * \param vid The vertex id.
    * \return the predecessor vector
    */
-  DGLIdIters PredVec(dgl_id_t vid) const override {
-    return GetInCSR()->SuccVec(vid);
-  }
+  DGLIdIters PredVec(dgl_id_t vid) const override;
 
   /*!
    * \brief Return the in edge id vector
    * \param vid The vertex id.
    * \return the in edge id vector
    */
-  DGLIdIters InEdgeVec(dgl_id_t vid) const override {
-    return GetInCSR()->OutEdgeVec(vid);
-  }
+  DGLIdIters InEdgeVec(dgl_id_t vid) const override;
 
   /*!
    * \brief Get the adjacency matrix of the graph.
@@ -879,7 +900,35 @@ class ImmutableGraph: public GraphInterface {
   /* !\brief Return coo. If not exist, create from csr.*/
   COOPtr GetCOO() const;
 
-  /*! \brief Create an immutable graph from CSR. */
+  /*!
+   * \brief Build the given formats now if they do not exist yet.
+   *
+   * The formats are built one after another, each conversion using all the
+   * threads. This is useful to avoid paying for a transpose in the middle of
+   * a hot (possibly multi-threaded) code path. This is also the only way to
+   * keep an uncompressed format of a compressed graph.
+   *
+   * \param formats The formats to build. Valid values are "in_csr", "out_csr"
+   *        and "coo".
+   */
+  void Materialize(const std::vector<std::string>& formats) const;
+
+  /* !\brief Return the compressed in csr, or nullptr if the graph is not compressed.*/
+  CompressedCSRPtr GetCompressedInCSR() const {
+    return compressed_in_csr_;
+  }
+
+  /* !\brief Return the compressed out csr, or nullptr if the graph is not compressed.*/
+  CompressedCSRPtr GetCompressedOutCSR() const {
+    return compressed_out_csr_;
+  }
+
+  /*!
+   * \brief Create an immutable graph from CSR.
+   *
+   * The edge_ids array can be undefined, in which case the edge ids follow
+   * the CSR order.
+   */
   static ImmutableGraphPtr CreateFromCSR(
       IdArray indptr, IdArray indices, IdArray edge_ids, const std::string &edge_dir);
 
@@ -942,6 +991,71 @@ class ImmutableGraph: public GraphInterface {
    */
   static ImmutableGraphPtr AsNumBits(ImmutableGraphPtr g, uint8_t bits);
 
+  /*!
+   * \brief Convert the graph to use compressed CSR storage.
+   *
+   * Both CSRs are built if needed and compressed. The returned graph does not
+   * hold any of the uncompressed formats.
+   *
+   * \param g The graph on CPU.
+   * \return The compressed graph.
+   */
+  static ImmutableGraphPtr Compress(ImmutableGraphPtr g);
+
+  /*!
+   * \brief Save the graph to a binary file.
+   *
+   * The CSRs that have been built are saved. If there is none, the out CSR is
+   * built and saved. Implicit edge ids are not stored.
+   *
+   * \param path The path of the file.
+   */
+  void Save(const std::string &path) const;
+
+  /*!
+   * \brief Load a graph saved by Save.
+   *
+   * The file is mapped read-only and the graph uses the mapped arrays
+   * directly, so loading does not read or copy the graph structure. The
+   * csrs are marked as mapped (see CSR::IsMapped). The indptr arrays are
+   * always validated.
+   *
+   * \param path The path of the file.
+   * \param verify_checksum Whether to check the file content against the
+   *        stored checksum, which reads the whole file. If not, the vertex and
+   *        edge ids are range checked instead, which reads the same arrays.
+   * \return The graph on CPU.
+   */
+  static ImmutableGraphPtr Load(const std::string &path, bool verify_checksum = true);
+
+  /*!
+   * \brief Load a graph from an edge list file.
+   *
+   * The file is parsed in parallel and the out CSR is built directly from it.
+   * The rows of the CSR are sorted and the edges are numbered in file order.
+   * The removed edges do not take an id, and the parallel edges that are
+   * removed keep the id of the first one. An empty file gives a graph
+   * without edges.
+   *
+   * A text edge list has one edge per line, given as the source and the
+   * destination ids separated by spaces, tabs or commas. Further columns are
+   * ignored, and so are blank lines and lines starting with '#' or '%'. A
+   * binary edge list is a sequence of (source, destination) pairs of int32
+   * or int64 integers in the native byte order.
+   *
+   * \param path The path of the file.
+   * \param format "text", "int32" or "int64".
+   * \param num_vertices The number of vertices. If negative, it is the
+   *        largest vertex id plus one, which costs one more pass over the file.
+   * \param remove_self_loops Whether to drop the self loops.
+   * \param remove_duplicates Whether to keep only one of the parallel edges.
+   * \param bits The number of integer bits of the graph (32 or 64).
+   * \return The graph on CPU.
+   */
+  static ImmutableGraphPtr LoadEdgeList(
+      const std::string &path, const std::string &format, int64_t num_vertices,
+      bool remove_self_loops, bool remove_duplicates, uint8_t bits);
+
   /*!
    * \brief Return a new graph with all the edges reversed.
    *
@@ -967,23 +1081,56 @@ class ImmutableGraph: public GraphInterface {
     this->shared_mem_name_ = shared_mem_name;
   }
 
-  /* !\brief return pointer to any available graph structure */
+  /*!
+   * \brief return pointer to any available graph structure
+   * \note If the graph only has compressed CSRs, the out CSR is decompressed.
+   */
   GraphPtr AnyGraph() const {
-    if (in_csr_) {
-      return in_csr_;
-    } else if (out_csr_) {
-      return out_csr_;
+    if (CSRPtr in_csr = CurrentInCSR()) {
+      return in_csr;
+    } else if (CSRPtr out_csr = CurrentOutCSR()) {
+      return out_csr;
+    } else if (COOPtr coo = CurrentCOO()) {
+      return coo;
     } else {
-      return coo_;
+      return GetOutCSR();
     }
   }
 
+  /* !\brief return any compressed csr, or nullptr if the graph is not compressed */
+  CompressedCSRPtr AnyCompressedCSR() const {
+    return compressed_out_csr_ ? compressed_out_csr_ : compressed_in_csr_;
+  }
+
+  /* !\brief Return in csr if it has been built, otherwise nullptr.*/
+  CSRPtr CurrentInCSR() const {
+    return std::atomic_load(&in_csr_);
+  }
+
+  /* !\brief Return out csr if it has been built, otherwise nullptr.*/
+  CSRPtr CurrentOutCSR() const {
+    return std::atomic_load(&out_csr_);
+  }
+
+  /* !\brief Return coo if it has been built, otherwise nullptr.*/
+  COOPtr CurrentCOO() const {
+    return std::atomic_load(&coo_);
+  }
+
   // Store the in csr (i.e, the reverse csr)
   CSRPtr in_csr_;
   // Store the out csr (i.e, the normal csr)
   CSRPtr out_csr_;
   // Store the edge list indexed by edge id (COO)
   COOPtr coo_;
+  // The formats are built lazily. The pointers above are read and written
+  //   atomically, and each format is built under its own mutex so that it is
+  //   built only once even if requested by multiple threads concurrently.
+  //   The mutexes are not copied along with the graph.
+  mutable std::mutex in_csr_mutex_, out_csr_mutex_, coo_mutex_;
+  // Compressed in/out csr. They are set at construction and never change.
+  CompressedCSRPtr compressed_in_csr_;
+  CompressedCSRPtr compressed_out_csr_;
 
   // The name of shared memory for this graph.
   // If it's empty, the graph isn't stored in shared memory.
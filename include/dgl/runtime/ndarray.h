@@ -166,6 +166,16 @@ class NDArray {
                                      DLDataType dtype,
                                      DLContext ctx,
                                      bool is_create);
+  /*!
+   * \brief Create a byte array backed by a read-only mapping of a file.
+   *
+   * The whole file is mapped. Use CreateView to interpret parts of it. The
+   * memory must not be written.
+   *
+   * \param path The path of the file.
+   * \return The created Array of int8 on CPU.
+   */
+  DGL_DLL static NDArray MapFile(const std::string &path);
   /*!
    * \brief Get the size of the array in the number of bytes.
    */
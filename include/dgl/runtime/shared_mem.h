@@ -65,6 +65,14 @@ class SharedMemory {
    * \return the address of the shared memory
    */
   void *open(size_t size);
+  /*
+   * \brief map an existing file read-only.
+   * Here `name` is the path of the file. The file is not removed when the
+   * object is destroyed.
+   * \param[out] size the size of the file, which is entirely mapped.
+   * \return the address of the mapping
+   */
+  void *map_file(size_t *size);
 };
 #endif  // _WIN32
 
@@ -367,16 +367,24 @@ class BinaryReduce(mx.autograd.Function):
         out_data = nd.empty((self.out_size,) + feat_shape,
                             ctx=lhs_data.context, dtype=lhs_data.dtype)
         out_data_nd = zerocopy_to_dgl_ndarray_for_write(out_data)
+        edge_cache_nd = None
+        num_edges = self.graph.number_of_edges()
+        if K.use_edge_cache(self.reducer, num_edges, feat_shape,
+                            np.dtype(lhs_data.dtype).itemsize):
+            edge_cache = nd.empty((num_edges,) + feat_shape,
+                                  ctx=lhs_data.context, dtype=lhs_data.dtype)
+            edge_cache_nd = zerocopy_to_dgl_ndarray_for_write(edge_cache)
         K.binary_op_reduce(
             self.reducer, self.binary_op, self.graph, self.lhs, self.rhs,
             lhs_data_nd, rhs_data_nd, out_data_nd, self.lhs_map[0],
-            self.rhs_map[0], self.out_map[0])
+            self.rhs_map[0], self.out_map[0], edge_cache_nd)
         self.save_for_backward(lhs_data_nd, rhs_data_nd, out_data_nd,
-                               feat_shape)
+                               feat_shape, edge_cache_nd)
         return out_data
 
     def backward(self, grad_out):
-        lhs_data_nd, rhs_data_nd, out_data_nd, feat_shape = self.saved_tensors
+        lhs_data_nd, rhs_data_nd, out_data_nd, feat_shape, edge_cache_nd \
+            = self.saved_tensors
         grad_out_nd = zerocopy_to_dgl_ndarray(grad_out)
         grad_lhs = nd.empty((lhs_data_nd.shape[0],) + feat_shape,
                             ctx=grad_out.context, dtype=grad_out.dtype)
@@ -384,7 +392,7 @@ class BinaryReduce(mx.autograd.Function):
             self.reducer, self.binary_op, self.graph, self.lhs, self.rhs,
             lhs_data_nd, rhs_data_nd, out_data_nd, grad_out_nd,
             zerocopy_to_dgl_ndarray_for_write(grad_lhs), self.lhs_map[1],
-            self.rhs_map[1], self.out_map[1])
+            self.rhs_map[1], self.out_map[1], edge_cache_nd)
         grad_lhs = _reduce_grad(grad_lhs, lhs_data_nd.shape)
         grad_rhs = nd.empty((rhs_data_nd.shape[0],) + feat_shape,
                              ctx=grad_out.context, dtype=grad_out.dtype)
@@ -392,7 +400,7 @@ class BinaryReduce(mx.autograd.Function):
             self.reducer, self.binary_op, self.graph, self.lhs, self.rhs,
             lhs_data_nd, rhs_data_nd, out_data_nd, grad_out_nd,
             zerocopy_to_dgl_ndarray_for_write(grad_rhs), self.lhs_map[1],
-            self.rhs_map[1], self.out_map[1])
+            self.rhs_map[1], self.out_map[1], edge_cache_nd)
         grad_rhs = _reduce_grad(grad_rhs, rhs_data_nd.shape)
         # clear saved tensors explicitly
         self.saved_tensors = None
@@ -288,19 +288,25 @@ class BinaryReduce(th.autograd.Function):
         feat_shape = K.infer_binary_feature_shape(lhs_data_nd, rhs_data_nd)
         out_data = lhs_data.new_empty((out_size,) + feat_shape)
         out_data_nd = zerocopy_to_dgl_ndarray(out_data)
+        edge_cache_nd = None
+        num_edges = graph.number_of_edges()
+        if K.use_edge_cache(reducer, num_edges, feat_shape,
+                            lhs_data.element_size()):
+            edge_cache = lhs_data.new_empty((num_edges,) + feat_shape)
+            edge_cache_nd = zerocopy_to_dgl_ndarray(edge_cache)
         K.binary_op_reduce(
             reducer, binary_op, graph, lhs, rhs, lhs_data_nd, rhs_data_nd,
-            out_data_nd, lhs_map[0], rhs_map[0], out_map[0])
+            out_data_nd, lhs_map[0], rhs_map[0], out_map[0], edge_cache_nd)
         # save_for_backward can only save variables
         ctx.backward_cache = (reducer, binary_op, graph, lhs, rhs, lhs_map,
                               rhs_map, out_map, lhs_data_nd, rhs_data_nd,
-                              out_data_nd, feat_shape)
+                              out_data_nd, feat_shape, edge_cache_nd)
         return out_data
 
     @staticmethod
     def backward(ctx, grad_out):
         reducer, binary_op, graph, lhs, rhs, lhs_map, rhs_map, out_map, \
-            lhs_data_nd, rhs_data_nd, out_data_nd, feat_shape \
+            lhs_data_nd, rhs_data_nd, out_data_nd, feat_shape, edge_cache_nd \
             = ctx.backward_cache
         ctx.backward_cache = None
         grad_lhs = None
@@ -311,14 +317,14 @@ class BinaryReduce(th.autograd.Function):
             K.backward_lhs_binary_op_reduce(
                 reducer, binary_op, graph, lhs, rhs, lhs_data_nd, rhs_data_nd,
                 out_data_nd, grad_out_nd, zerocopy_to_dgl_ndarray(grad_lhs),
-                lhs_map[1], rhs_map[1], out_map[1])
+                lhs_map[1], rhs_map[1], out_map[1], edge_cache_nd)
             grad_lhs = _reduce_grad(grad_lhs, lhs_data_nd.shape)
         if ctx.needs_input_grad[6]:
             grad_rhs = grad_out.new_empty((rhs_data_nd.shape[0],) + feat_shape)
             K.backward_rhs_binary_op_reduce(
                 reducer, binary_op, graph, lhs, rhs, lhs_data_nd, rhs_data_nd,
                 out_data_nd, grad_out_nd, zerocopy_to_dgl_ndarray(grad_rhs),
-                lhs_map[1], rhs_map[1], out_map[1])
+                lhs_map[1], rhs_map[1], out_map[1], edge_cache_nd)
             grad_rhs = _reduce_grad(grad_rhs, rhs_data_nd.shape)
 
         return None, None, None, None, None, grad_lhs, grad_rhs, None, None, \
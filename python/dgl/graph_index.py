@@ -917,6 +917,71 @@ class GraphIndex(ObjectBase):
         """
         return _CAPI_DGLImmutableGraphAsNumBits(self, int(bits))
 
+    def materialize(self, formats=('in_csr', 'out_csr')):
+        """Build the given storage formats of the graph now.
+
+        An immutable graph index builds its missing formats lazily on first use.
+        Building them up front (each conversion using all the threads) avoids
+        paying for the conversion in the middle of, e.g., multi-threaded
+        sampling. A compressed graph index only keeps the uncompressed formats
+        built here.
+
+        NOTE: this method only works for immutable graph index
+
+        Parameters
+        ----------
+        formats : iterable of str
+            The formats to build. Valid values are "in_csr", "out_csr" and "coo".
+        """
+        formats = set(formats)
+        for fmt in formats:
+            if fmt not in ('in_csr', 'out_csr', 'coo'):
+                raise DGLError('Unsupported graph format: %s' % fmt)
+        _CAPI_DGLImmutableGraphMaterialize(
+            self, 'in_csr' in formats, 'out_csr' in formats, 'coo' in formats)
+
+    def compress(self):
+        """Transform the graph to a new one stored in compressed CSR format.
+
+        Both CSRs are kept, with the neighbor lists delta-encoded and
+        bit-packed, and identity edge ids not stored. Degree queries,
+        per-vertex queries and neighbor and layer sampling decode the
+        compressed rows directly. Other operations decompress the format they
+        need on every call; use ``materialize`` to keep it instead.
+
+        NOTE: this method only works for immutable graph index on CPU
+
+        Returns
+        -------
+        GraphIndex
+            The compressed graph index.
+        """
+        return _CAPI_DGLImmutableGraphCompress(self)
+
+    def compressed_size(self):
+        """Return the number of bytes used by the compressed CSRs.
+
+        NOTE: this method only works for immutable graph index
+
+        Returns
+        -------
+        int
+            The number of bytes, or 0 if the graph is not compressed.
+        """
+        return _CAPI_DGLImmutableGraphCompressedSize(self)
+
+    def save(self, path):
+        """Save the graph to a binary file that can be loaded by ``from_file``.
+
+        NOTE: this method only works for immutable graph index on CPU
+
+        Parameters
+        ----------
+        path : str
+            The path of the file.
+        """
+        _CAPI_DGLImmutableGraphSave(self, path)
+
 class SubgraphIndex(object):
     """Internal subgraph data structure.
 
@@ -1042,6 +1107,62 @@ def from_shared_mem_csr_matrix(shared_mem_name,
         edge_dir)
     return gidx
 
+def from_file(path, verify_checksum=True):
+    """Load an immutable graph saved by ``GraphIndex.save``.
+
+    The file is memory-mapped read-only and the graph structure is used in
+    place, so loading takes constant time except for the validation: either
+    the checksum check, or a range check of the ids if it is disabled.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file.
+    verify_checksum : bool
+        Whether to check the file content against the stored checksum. If
+        False, the vertex and edge ids are range checked instead.
+
+    Returns
+    -------
+    GraphIndex
+        The graph index on CPU.
+    """
+    return _CAPI_DGLImmutableGraphLoad(path, verify_checksum)
+
+def from_edge_list_file(path, fmt='text', num_nodes=None, remove_self_loops=False,
+                        remove_duplicates=False, num_bits=64):
+    """Load an immutable graph from an edge list file.
+
+    The file is parsed in parallel in C++ without going through numpy arrays.
+    The edges are numbered in file order, skipping the removed ones.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file.
+    fmt : str
+        ``'text'`` for one ``src dst`` pair per line, separated by spaces, tabs
+        or commas (further columns, blank lines and lines starting with ``#``
+        or ``%`` are ignored). ``'int32'`` or ``'int64'`` for a binary file of
+        (src, dst) pairs.
+    num_nodes : int, optional
+        The number of nodes. Inferred from the largest node id if not given.
+    remove_self_loops : bool
+        Whether to drop the self loops.
+    remove_duplicates : bool
+        Whether to keep only one of the parallel edges.
+    num_bits : int
+        The number of integer bits of the graph (32 or 64).
+
+    Returns
+    -------
+    GraphIndex
+        The graph index on CPU.
+    """
+    num_nodes = -1 if num_nodes is None else int(num_nodes)
+    return _CAPI_DGLImmutableGraphLoadEdgeList(path, fmt, num_nodes, remove_self_loops,
+                                               remove_duplicates, int(num_bits))
+
 def from_networkx(nx_graph, readonly):
     """Convert from networkx graph.
 
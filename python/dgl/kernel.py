@@ -4,6 +4,54 @@ from __future__ import absolute_import
 from ._ffi.function import _init_api
 from .ndarray import empty
 
+# Maximum number of bytes of the per-edge cache kept by a binary reduce call
+# for its backward pass. Zero disables the cache.
+_EDGE_CACHE_LIMIT = 0
+
+def set_edge_cache_limit(nbytes):
+    """Set the maximum size of the per-edge cache that a binary reduce call
+    may keep for its backward pass.
+
+    With the cache, the forward pass saves the per-edge result of the binary
+    operation, and the backward pass reads it instead of recomputing it. The
+    cache is owned by the call and released after the backward pass, so this
+    bounds the extra peak memory of each call. Zero (the default) disables
+    the cache.
+
+    Parameter
+    ---------
+    nbytes : int
+        The maximum number of bytes of the cache of one call.
+    """
+    global _EDGE_CACHE_LIMIT
+    _EDGE_CACHE_LIMIT = int(nbytes)
+
+def use_edge_cache(reducer, num_edges, feat_shape, itemsize=4):
+    """Return True if a binary reduce call should keep a per-edge cache.
+
+    Parameter
+    ---------
+    reducer : str
+        The type of the reducer. No cache is needed for "none" since the
+        output already holds the per-edge result.
+    num_edges : int
+        The number of edges of the graph.
+    feat_shape : tuple of int
+        The output feature shape.
+    itemsize : int
+        The number of bytes of one element.
+
+    Returns
+    -------
+    bool
+    """
+    if reducer == 'none' or _EDGE_CACHE_LIMIT <= 0:
+        return False
+    nbytes = num_edges * itemsize
+    for dim in feat_shape:
+        nbytes *= dim
+    return nbytes <= _EDGE_CACHE_LIMIT
+
 def infer_binary_feature_shape(lhs, rhs):
     """Infer the output feature shape after a binary operation between lhs and rhs.
 
@@ -24,7 +72,7 @@ def infer_binary_feature_shape(lhs, rhs):
 
 # pylint: disable=invalid-name
 def binary_op_reduce(reducer, op, G, A_target, B_target, A, B, out,
-                     A_rows=None, B_rows=None, out_rows=None):
+                     A_rows=None, B_rows=None, out_rows=None, edge_cache=None):
     """Perform binary operation on the edges of graph ``G``, and optionally
     reduce the per-edge result by edge destinations into per-node result.
 
@@ -131,6 +179,11 @@ def binary_op_reduce(reducer, op, G, A_target, B_target, A, B, out,
         The rows to read from B.
     out_rows : NDArray
         The rows to write to output tensor.
+    edge_cache : NDArray, optional
+        If given, the per-edge result ``C`` is also written to it so that the
+        backward functions can reuse it instead of recomputing ``C``. Its
+        shape should be ``(G.number_of_edges(),) + out.shape[1:]``.
+        See also ``use_edge_cache``.
     """
     if A_rows is None:
         A_rows = empty([])
@@ -138,11 +191,13 @@ def binary_op_reduce(reducer, op, G, A_target, B_target, A, B, out,
         B_rows = empty([])
     if out_rows is None:
         out_rows = empty([])
+    if edge_cache is None:
+        edge_cache = empty([])
     _CAPI_DGLKernelBinaryOpReduce(
         reducer, op, G,
         int(A_target), int(B_target),
         A, B, out,
-        A_rows, B_rows, out_rows)
+        A_rows, B_rows, out_rows, edge_cache)
 
 # pylint: disable=invalid-name
 def backward_lhs_binary_op_reduce(
@@ -150,7 +205,7 @@ def backward_lhs_binary_op_reduce(
         A_target, B_target,
         A, B, out,
         grad_out, grad_A,
-        A_rows=None, B_rows=None, out_rows=None):
+        A_rows=None, B_rows=None, out_rows=None, edge_cache=None):
     """Compute the gradient of ``binary_op_reduce`` w.r.t. ``A`` and store it
     in ``grad_A``.
 
@@ -195,6 +250,9 @@ def backward_lhs_binary_op_reduce(
         The rows read from B.
     out_rows : NDArray
         The rows written to output tensor.
+    edge_cache : NDArray, optional
+        The per-edge result saved by ``binary_op_reduce``. If given, the
+        result is not recomputed.
     """
     if A_rows is None:
         A_rows = empty([])
@@ -202,12 +260,14 @@ def backward_lhs_binary_op_reduce(
         B_rows = empty([])
     if out_rows is None:
         out_rows = empty([])
+    if edge_cache is None:
+        edge_cache = empty([])
     _CAPI_DGLKernelBackwardLhsBinaryOpReduce(
         reducer, op, G,
         int(A_target), int(B_target),
         A_rows, B_rows, out_rows,
         A, B, out,
-        grad_out, grad_A)
+        grad_out, grad_A, edge_cache)
 
 # pylint: disable=invalid-name
 def backward_rhs_binary_op_reduce(
@@ -215,7 +275,7 @@ def backward_rhs_binary_op_reduce(
         A_target, B_target,
         A, B, out,
         grad_out, grad_B,
-        A_rows=None, B_rows=None, out_rows=None):
+        A_rows=None, B_rows=None, out_rows=None, edge_cache=None):
     """Compute the gradient of ``binary_op_reduce`` w.r.t. ``B`` and store it
     in ``grad_B``.
 
@@ -260,6 +320,9 @@ def backward_rhs_binary_op_reduce(
         The rows read from B.
     out_rows : NDArray
         The rows written to output tensor.
+    edge_cache : NDArray, optional
+        The per-edge result saved by ``binary_op_reduce``. If given, the
+        result is not recomputed.
     """
     if A_rows is None:
         A_rows = empty([])
@@ -267,12 +330,14 @@ def backward_rhs_binary_op_reduce(
         B_rows = empty([])
     if out_rows is None:
         out_rows = empty([])
+    if edge_cache is None:
+        edge_cache = empty([])
     _CAPI_DGLKernelBackwardRhsBinaryOpReduce(
         reducer, op, G,
         int(A_target), int(B_target),
         A_rows, B_rows, out_rows,
         A, B, out,
-        grad_out, grad_B)
+        grad_out, grad_B, edge_cache)
 
 # pylint: disable=invalid-name
 def copy_reduce(reducer, G, target,
@@ -411,4 +476,101 @@ def backward_copy_reduce(reducer, G, target,
         X, out, grad_out, grad_X,
         X_rows, out_rows)
 
+# pylint: disable=invalid-name
+def hetero_copy_reduce(reducer, G, dst_type, target, Xs, out, etype_weight=None):
+    """Copy data in ``Xs`` onto the edges of every relation of heterograph
+    ``G`` whose destination node type is ``dst_type``, and reduce all the
+    per-edge results into per-node results of ``dst_type`` in one pass.
+
+    Details
+    -------
+    For every node ``v`` of type ``dst_type``,::
+
+        out[v] = reducer_{r, e: (u, v, e) in G_r} w[r] * Xs[r][select_target(u, v, e)]
+
+    where ``G_r`` is the relation graph of edge type ``r`` and ``w[r]`` is
+    ``etype_weight[r]`` (or one if ``etype_weight`` is None). This is
+    equivalent to calling ``copy_reduce`` on every relation graph and then
+    combining the results with the same reducer, but uses a single kernel
+    call and a single write of ``out``. The "mean" reducer divides the sum by
+    the number of in-edges of ``v`` over all the relations, and gives zero
+    to the nodes without any.
+
+    Parameter
+    ---------
+    reducer : str
+        The type of the reducer ("sum", "max", "min", "prod", "mean").
+    G : HeteroGraphIndex
+        The heterograph
+    dst_type : int
+        The destination node type.
+    target : int
+        Choice of source (0) or edge (2) ID for edges to index in data tensor.
+    Xs : list of NDArray or None
+        Data tensor of each edge type. None skips the relation.
+    out : NDArray (output)
+        Output tensor.  The result will be written there in place.
+    etype_weight : NDArray, optional
+        The weight of each edge type.
+    """
+    Xs = [empty([]) if X is None else X for X in Xs]
+    if etype_weight is None:
+        etype_weight = empty([])
+    _CAPI_DGLKernelHeteroCopyReduce(
+        reducer, G, int(dst_type), int(target),
+        Xs, etype_weight, out)
+
+def set_profiler_enabled(enabled):
+    """Enable or disable the profiling of kernel calls.
+
+    When enabled, every binary reduce and copy reduce call records its op,
+    reducer, targets, number of edges, feature length, dtype, wall time and
+    the estimated bytes touched. On GPU, the stream is synchronized before
+    and after every call so that the time covers the execution of the
+    kernels, which serializes the calls while profiling. The profiler can
+    also be enabled at startup by setting the environment variable
+    ``DGL_KERNEL_PROFILE=1``.
+
+    Parameter
+    ---------
+    enabled : bool
+        Whether to enable the profiler.
+    """
+    _CAPI_DGLKernelProfilerSetEnabled(bool(enabled))
+
+def is_profiler_enabled():
+    """Return True if the kernel profiler is enabled."""
+    return bool(_CAPI_DGLKernelProfilerEnabled())
+
+def reset_profiler():
+    """Clear all the calls recorded by the kernel profiler."""
+    _CAPI_DGLKernelProfilerReset()
+
+def profiler_summary():
+    """Return the summary of the recorded kernel calls.
+
+    Calls are grouped by the kernel, op, reducer, targets and dtype. For
+    each group, the number of calls, the total/mean/min/max wall time, the
+    bytes touched and a log2 histogram of the wall time are reported.
+
+    Returns
+    -------
+    str
+        The summary.
+    """
+    return _CAPI_DGLKernelProfilerSummary()
+
+def dump_profiler_trace(path):
+    """Dump the recorded kernel calls in Chrome trace format.
+
+    The file can be loaded with ``chrome://tracing``.
+
+    Parameter
+    ---------
+    path : str
+        The output file path.
+    """
+    with open(path, 'w') as f:
+        f.write(_CAPI_DGLKernelProfilerChromeTrace())
+
 _init_api("dgl.kernel")
@@ -257,6 +257,17 @@ bool CSRHasDuplicate(CSRMatrix csr) {
   return ret;
 }
 
+bool CSRIsSorted(CSRMatrix csr) {
+  if (csr.sorted) {
+    return true;
+  }
+  bool ret = false;
+  ATEN_CSR_IDX_SWITCH(csr, XPU, IdType, {
+    ret = impl::CSRIsSorted<XPU, IdType>(csr);
+  });
+  return ret;
+}
+
 int64_t CSRGetRowNNZ(CSRMatrix csr, int64_t row) {
   int64_t ret = 0;
   ATEN_CSR_IDX_SWITCH(csr, XPU, IdType, {
@@ -54,6 +54,9 @@ runtime::NDArray CSRIsNonZero(CSRMatrix csr, runtime::NDArray row, runtime::NDAr
 template <DLDeviceType XPU, typename IdType>
 bool CSRHasDuplicate(CSRMatrix csr);
 
+template <DLDeviceType XPU, typename IdType>
+bool CSRIsSorted(CSRMatrix csr);
+
 template <DLDeviceType XPU, typename IdType>
 int64_t CSRGetRowNNZ(CSRMatrix csr, int64_t row);
 
@@ -4,8 +4,11 @@
  * \brief Array operator CPU implementation
  */
 #include <dgl/array.h>
+#include <algorithm>
 #include <numeric>
 #include "../arith.h"
+#include "./id_map.h"
+#include "./parallel_util.h"
 
 namespace dgl {
 using runtime::NDArray;
@@ -166,10 +169,14 @@ IdArray IndexSelect(IdArray array, IdArray index) {
   const int64_t len = index->shape[0];
   IdArray ret = NDArray::Empty({len}, array->dtype, array->ctx);
   IdType* ret_data = static_cast<IdType*>(ret->data);
+  bool valid = true;
+#pragma omp parallel for reduction(&&:valid) if (len >= kParallelGrainSize)
   for (int64_t i = 0; i < len; ++i) {
-    CHECK_LT(idx_data[i], arr_len) << "Index out of range.";
-    ret_data[i] = array_data[idx_data[i]];
+    const bool in_range = idx_data[i] >= 0 && idx_data[i] < arr_len;
+    valid = valid && in_range;
+    ret_data[i] = in_range ? array_data[idx_data[i]] : 0;
   }
+  CHECK(valid) << "Index out of range.";
   return ret;
 }
 
@@ -189,25 +196,40 @@ template int64_t IndexSelect<kDLCPU, int64_t>(IdArray array, int64_t index);
 
 template <DLDeviceType XPU, typename IdType>
 IdArray Relabel_(const std::vector<IdArray>& arrays) {
-  // build map & relabel
-  IdType newid = 0;
-  std::unordered_map<IdType, IdType> oldv2newv;
+  int64_t total_len = 0;
+  IdType max_id = -1;
   for (IdArray arr : arrays) {
+    const IdType* arr_data = static_cast<IdType*>(arr->data);
+    const int64_t len = arr->shape[0];
+    IdType arr_max = -1;
+#pragma omp parallel for reduction(max:arr_max) if (len >= kParallelGrainSize)
+    for (int64_t i = 0; i < len; ++i) {
+      arr_max = std::max(arr_max, arr_data[i]);
+    }
+    max_id = std::max(max_id, arr_max);
+    total_len += len;
+  }
+  // build the map sequentially, since the new ids follow the first occurrences
+  IdMap<IdType> oldv2newv(max_id + 1, total_len);
+  std::vector<IdType> newv2oldv;
+  for (IdArray arr : arrays) {
+    const IdType* arr_data = static_cast<IdType*>(arr->data);
     for (int64_t i = 0; i < arr->shape[0]; ++i) {
-      const IdType id = static_cast<IdType*>(arr->data)[i];
-      if (!oldv2newv.count(id)) {
-        oldv2newv[id] = newid++;
+      if (oldv2newv.Insert(arr_data[i]) == static_cast<IdType>(newv2oldv.size())) {
+        newv2oldv.push_back(arr_data[i]);
       }
-      static_cast<IdType*>(arr->data)[i] = oldv2newv[id];
     }
   }
-  // map array
-  IdArray maparr = NewIdArray(newid);
-  IdType* maparr_data = static_cast<IdType*>(maparr->data);
-  for (const auto& kv : oldv2newv) {
-    maparr_data[kv.second] = kv.first;
+  // relabel
+  for (IdArray arr : arrays) {
+    IdType* arr_data = static_cast<IdType*>(arr->data);
+    const int64_t len = arr->shape[0];
+#pragma omp parallel for if (len >= kParallelGrainSize)
+    for (int64_t i = 0; i < len; ++i) {
+      arr_data[i] = oldv2newv.Map(arr_data[i], -1);
+    }
   }
-  return maparr;
+  return VecToIdArray(newv2oldv, sizeof(IdType) * 8, arrays[0]->ctx);
 }
 
 template IdArray Relabel_<kDLCPU, int32_t>(const std::vector<IdArray>& arrays);
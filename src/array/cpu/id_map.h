@@ -0,0 +1,91 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file array/cpu/id_map.h
+ * \brief Relabeling of ids into consecutive new ids.
+ */
+#ifndef DGL_ARRAY_CPU_ID_MAP_H_
+#define DGL_ARRAY_CPU_ID_MAP_H_
+
+#include <dmlc/logging.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+/*!
+ * \brief Map ids to new consecutive ids in the order they are inserted.
+ *
+ * A dense table indexed by the old id is used when the id range is at most
+ * kDenseRatio times the number of inserted ids, so that its size stays
+ * proportional to the result. A hash map is used otherwise.
+ *
+ * Insertions are sequential; lookups are thread safe.
+ */
+template <typename IdType>
+class IdMap {
+ public:
+  /*! \brief Use a dense table if the id range is at most this times the number of ids. */
+  static constexpr int64_t kDenseRatio = 16;
+
+  /*!
+   * \param id_range All the ids are in [0, id_range).
+   * \param num_ids The expected number of insertions.
+   */
+  IdMap(int64_t id_range, int64_t num_ids)
+    : dense_(id_range <= kDenseRatio * num_ids) {
+    if (dense_) {
+      table_.assign(id_range, -1);
+    } else {
+      hashmap_.reserve(num_ids);
+    }
+  }
+
+  /*! \return the new id of the given id, which is assigned if the id is new */
+  IdType Insert(IdType id) {
+    if (dense_) {
+      CHECK(id >= 0 && id < static_cast<int64_t>(table_.size())) << "Invalid id: " << id;
+      IdType& newid = table_[id];
+      if (newid == -1) {
+        newid = size_++;
+      }
+      return newid;
+    } else {
+      auto it = hashmap_.insert({id, size_});
+      if (it.second) {
+        ++size_;
+      }
+      return it.first->second;
+    }
+  }
+
+  /*! \return the new id of the given id, or default_val if it is not in the map */
+  IdType Map(IdType id, IdType default_val) const {
+    if (dense_) {
+      return (id >= 0 && id < static_cast<int64_t>(table_.size()) && table_[id] != -1)
+        ? table_[id] : default_val;
+    } else {
+      auto it = hashmap_.find(id);
+      return (it == hashmap_.end()) ? default_val : it->second;
+    }
+  }
+
+  /*! \return the number of distinct ids */
+  int64_t Size() const {
+    return size_;
+  }
+
+ private:
+  bool dense_;
+  std::vector<IdType> table_;
+  std::unordered_map<IdType, IdType> hashmap_;
+  IdType size_ = 0;
+};
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_ID_MAP_H_
@@ -0,0 +1,87 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file array/cpu/parallel_util.h
+ * \brief Utilities for OpenMP parallel array operators on CPU.
+ */
+#ifndef DGL_ARRAY_CPU_PARALLEL_UTIL_H_
+#define DGL_ARRAY_CPU_PARALLEL_UTIL_H_
+
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+/*!
+ * \brief Below this number of elements, the parallel operators fall back
+ *        to their sequential version.
+ */
+constexpr int64_t kParallelGrainSize = 1 << 16;
+
+/*!
+ * \brief Split [0, n) into nthreads contiguous ranges and return the tid-th one.
+ */
+inline void ThreadRange(int64_t n, int tid, int nthreads, int64_t* begin, int64_t* end) {
+  const int64_t chunk = n / nthreads;
+  const int64_t rem = n % nthreads;
+  *begin = tid * chunk + std::min<int64_t>(tid, rem);
+  *end = *begin + chunk + (tid < rem ? 1 : 0);
+}
+
+/*!
+ * \brief In-place exclusive prefix sum.
+ *
+ * On return, data[i] is the sum of the original data[0], ..., data[i-1].
+ *
+ * \param data The array.
+ * \param n The number of elements.
+ * \return The sum of all the elements.
+ */
+template <typename IdType>
+IdType ExclusiveScan(IdType* data, int64_t n) {
+  if (n < kParallelGrainSize || omp_get_max_threads() == 1) {
+    IdType cumsum = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      const IdType temp = data[i];
+      data[i] = cumsum;
+      cumsum += temp;
+    }
+    return cumsum;
+  }
+  const int max_threads = omp_get_max_threads();
+  // partial[t + 1] is the sum of the range of thread t
+  std::vector<IdType> partial(max_threads + 1, 0);
+#pragma omp parallel num_threads(max_threads)
+  {
+    const int tid = omp_get_thread_num();
+    int64_t begin, end;
+    ThreadRange(n, tid, omp_get_num_threads(), &begin, &end);
+    IdType sum = 0;
+    for (int64_t i = begin; i < end; ++i) {
+      sum += data[i];
+    }
+    partial[tid + 1] = sum;
+#pragma omp barrier
+#pragma omp single
+    {
+      for (int t = 0; t < max_threads; ++t) {
+        partial[t + 1] += partial[t];
+      }
+    }
+    IdType cumsum = partial[tid];
+    for (int64_t i = begin; i < end; ++i) {
+      const IdType temp = data[i];
+      data[i] = cumsum;
+      cumsum += temp;
+    }
+  }
+  return partial[max_threads];
+}
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_PARALLEL_UTIL_H_
@@ -4,8 +4,13 @@
  * \brief Sparse matrix operator CPU implementation
  */
 #include <dgl/array.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
 #include <vector>
 #include <unordered_set>
+#include "./id_map.h"
+#include "./parallel_util.h"
 
 namespace dgl {
 
@@ -14,53 +19,6 @@ using runtime::NDArray;
 namespace aten {
 namespace impl {
 namespace {
-/*!
- * \brief A hashmap that maps each ids in the given array to new ids starting from zero.
- */
-template <typename IdType>
-class IdHashMap {
- public:
-  // Construct the hashmap using the given id arrays.
-  // The id array could contain duplicates.
-  explicit IdHashMap(IdArray ids): filter_(kFilterSize, false) {
-    const IdType* ids_data = static_cast<IdType*>(ids->data);
-    const int64_t len = ids->shape[0];
-    IdType newid = 0;
-    for (int64_t i = 0; i < len; ++i) {
-      const IdType id = ids_data[i];
-      if (!Contains(id)) {
-        oldv2newv_[id] = newid++;
-        filter_[id & kFilterMask] = true;
-      }
-    }
-  }
-
-  // Return true if the given id is contained in this hashmap.
-  bool Contains(IdType id) const {
-    return filter_[id & kFilterMask] && oldv2newv_.count(id);
-  }
-
-  // Return the new id of the given id. If the given id is not contained
-  // in the hash map, returns the default_val instead.
-  IdType Map(IdType id, IdType default_val) const {
-    if (filter_[id & kFilterMask]) {
-      auto it = oldv2newv_.find(id);
-      return (it == oldv2newv_.end()) ? default_val : it->second;
-    } else {
-      return default_val;
-    }
-  }
-
- private:
-  static constexpr int32_t kFilterMask = 0xFFFFFF;
-  static constexpr int32_t kFilterSize = kFilterMask + 1;
-  // This bitmap is used as a bloom filter to remove some lookups.
-  // Hashtable is very slow. Using bloom filter can significantly speed up lookups.
-  std::vector<bool> filter_;
-  // The hashmap from old vid to new vid
-  std::unordered_map<IdType, IdType> oldv2newv_;
-};
-
 struct PairHash {
   template <class T1, class T2>
   std::size_t operator() (const std::pair<T1, T2>& pair) const {
@@ -78,12 +36,183 @@ inline runtime::NDArray VecToNDArray(const std::vector<DType>& vec,
   return ret_arr;
 }
 
-inline bool CSRHasData(CSRMatrix csr) {
-  return csr.data.defined();
+// Batched lookups are processed in parallel from this number of queries.
+constexpr int64_t kQueryGrainSize = 1024;
+
+/*!
+ * \brief Call fn(pos) on the position of every entry (row, col), in order.
+ *
+ * If the row is sorted, the entries are found by binary search.
+ */
+template <typename IdType, typename Fn>
+inline void ForEachEntry(const IdType* indptr, const IdType* indices, bool sorted,
+                         IdType row, IdType col, Fn fn) {
+  const IdType* begin = indices + indptr[row];
+  const IdType* end = indices + indptr[row + 1];
+  if (sorted) {
+    for (const IdType* it = std::lower_bound(begin, end, col); it != end && *it == col; ++it) {
+      fn(static_cast<IdType>(it - indices));
+    }
+  } else {
+    for (const IdType* it = begin; it != end; ++it) {
+      if (*it == col) {
+        fn(static_cast<IdType>(it - indices));
+      }
+    }
+  }
+}
+
+/*! \return the position of the first entry (row, col), or -1 if there is none */
+template <typename IdType>
+inline int64_t FindEntry(const IdType* indptr, const IdType* indices, bool sorted,
+                         IdType row, IdType col) {
+  const IdType* begin = indices + indptr[row];
+  const IdType* end = indices + indptr[row + 1];
+  const IdType* it = sorted ? std::lower_bound(begin, end, col) : std::find(begin, end, col);
+  return (it != end && *it == col) ? it - indices : -1;
+}
+
+/*!
+ * \brief Validated (row, col) queries with broadcasting: either array can be
+ *        of length 1.
+ */
+template <typename IdType>
+struct BatchedQuery {
+  const IdType* row_data;
+  const IdType* col_data;
+  int64_t row_stride, col_stride, num_queries;
+
+  BatchedQuery(const CSRMatrix& csr, NDArray rows, NDArray cols) {
+    const int64_t rowlen = rows->shape[0];
+    const int64_t collen = cols->shape[0];
+    CHECK((rowlen == collen) || (rowlen == 1) || (collen == 1))
+      << "Invalid row and col id array.";
+    row_stride = (rowlen == 1 && collen != 1) ? 0 : 1;
+    col_stride = (collen == 1 && rowlen != 1) ? 0 : 1;
+    num_queries = std::max(rowlen, collen);
+    row_data = static_cast<IdType*>(rows->data);
+    col_data = static_cast<IdType*>(cols->data);
+    bool valid = true;
+#pragma omp parallel for reduction(&&:valid) if (num_queries >= kParallelGrainSize)
+    for (int64_t i = 0; i < num_queries; ++i) {
+      valid = valid && Row(i) >= 0 && Row(i) < csr.num_rows
+        && Col(i) >= 0 && Col(i) < csr.num_cols;
+    }
+    if (!valid) {
+      for (int64_t i = 0; i < num_queries; ++i) {
+        CHECK(Row(i) >= 0 && Row(i) < csr.num_rows) << "Invalid row index: " << Row(i);
+        CHECK(Col(i) >= 0 && Col(i) < csr.num_cols) << "Invalid col index: " << Col(i);
+      }
+    }
+  }
+
+  IdType Row(int64_t i) const { return row_data[i * row_stride]; }
+  IdType Col(int64_t i) const { return col_data[i * col_stride]; }
+};
+
+/*!
+ * \brief Scatter entries into buckets of consecutive keys in parallel.
+ *
+ * This is the first pass of a parallel stable counting sort. The keys are
+ * split into buckets holding about the same number of entries. Each thread
+ * counts the entries of its own contiguous range of entries in every bucket,
+ * so that all threads can then write their entries to the buckets without
+ * synchronization.
+ *
+ * \param nnz The number of entries.
+ * \param indptr The offset of each key in the sorted order (num_keys + 1).
+ * \param num_keys The number of keys.
+ * \param key Function returning the key of the given entry.
+ * \param bucket_keys Bucket b holds keys [bucket_keys[b], bucket_keys[b + 1]).
+ * \return The entries grouped by bucket. Bucket b is stored in
+ *         [indptr[bucket_keys[b]], indptr[bucket_keys[b + 1]]) and its entries
+ *         are in increasing order.
+ */
+template <typename IdType, typename KeyFn>
+std::vector<IdType> BucketByKey(int64_t nnz, const IdType* indptr, int64_t num_keys,
+                                KeyFn key, std::vector<int64_t>* bucket_keys) {
+  const int nthreads = omp_get_max_threads();
+  // more buckets than threads to balance the second pass
+  const int64_t num_buckets = std::min<int64_t>(4 * nthreads, num_keys);
+  bucket_keys->resize(num_buckets + 1);
+  for (int64_t b = 0; b < num_buckets; ++b) {
+    (*bucket_keys)[b] = std::lower_bound(indptr, indptr + num_keys + 1,
+                                         b * nnz / num_buckets) - indptr;
+  }
+  (*bucket_keys)[num_buckets] = num_keys;
+  const auto bucket_of = [bucket_keys] (IdType k) {
+    return std::upper_bound(bucket_keys->begin() + 1, bucket_keys->end(), k)
+      - (bucket_keys->begin() + 1);
+  };
+  std::vector<IdType> offsets(nthreads * num_buckets, 0);
+  std::vector<IdType> ret(nnz);
+#pragma omp parallel num_threads(nthreads)
+  {
+    const int tid = omp_get_thread_num();
+    int64_t begin, end;
+    ThreadRange(nnz, tid, omp_get_num_threads(), &begin, &end);
+    IdType* my_offsets = offsets.data() + tid * num_buckets;
+    for (int64_t i = begin; i < end; ++i) {
+      ++my_offsets[bucket_of(key(i))];
+    }
+#pragma omp barrier
+#pragma omp single
+    {
+      // entries of thread t go after those of threads 0, ..., t - 1
+      for (int64_t b = 0; b < num_buckets; ++b) {
+        IdType off = indptr[(*bucket_keys)[b]];
+        for (int t = 0; t < nthreads; ++t) {
+          const IdType temp = offsets[t * num_buckets + b];
+          offsets[t * num_buckets + b] = off;
+          off += temp;
+        }
+      }
+    }
+    for (int64_t i = begin; i < end; ++i) {
+      ret[my_offsets[bucket_of(key(i))]++] = i;
+    }
+  }
+  return ret;
 }
 
-inline bool COOHasData(COOMatrix csr) {
-  return csr.data.defined();
+/*!
+ * \brief Count the entries of each key and compute the offsets in parallel.
+ *
+ * The entries are split into chunks, each counted by one thread into its own
+ * histogram, and the histograms are then summed per key. The number of chunks
+ * is capped so that the extra histograms take no more space than the keys.
+ *
+ * \param nnz The number of entries.
+ * \param keys The key of each entry.
+ * \param num_keys The number of keys.
+ * \param indptr The output offsets (num_keys + 1).
+ */
+template <typename IdType>
+void ComputeIndptr(int64_t nnz, const IdType* keys, int64_t num_keys, IdType* indptr) {
+  const int64_t num_chunks = (nnz >= kParallelGrainSize) ?
+    std::max<int64_t>(1, std::min<int64_t>(omp_get_max_threads(), nnz / (num_keys + 1))) : 1;
+  // the first chunk is counted in indptr
+  std::unique_ptr<IdType[]> counts(new IdType[(num_chunks - 1) * num_keys]);
+#pragma omp parallel for num_threads(num_chunks) if (num_chunks > 1)
+  for (int64_t c = 0; c < num_chunks; ++c) {
+    IdType* hist = (c == 0) ? indptr : counts.get() + (c - 1) * num_keys;
+    std::fill(hist, hist + num_keys, 0);
+    int64_t begin, end;
+    ThreadRange(nnz, c, num_chunks, &begin, &end);
+    for (int64_t i = begin; i < end; ++i) {
+      ++hist[keys[i]];
+    }
+  }
+  if (num_chunks > 1) {
+#pragma omp parallel for if (num_keys >= kParallelGrainSize)
+    for (int64_t k = 0; k < num_keys; ++k) {
+      for (int64_t c = 1; c < num_chunks; ++c) {
+        indptr[k] += counts[(c - 1) * num_keys + k];
+      }
+    }
+  }
+  indptr[num_keys] = 0;
+  ExclusiveScan(indptr, num_keys + 1);
 }
 }  // namespace
 
@@ -95,12 +224,7 @@ bool CSRIsNonZero(CSRMatrix csr, int64_t row, int64_t col) {
   CHECK(col >= 0 && col < csr.num_cols) << "Invalid col index: " << col;
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
-  for (IdType i = indptr_data[row]; i < indptr_data[row + 1]; ++i) {
-    if (indices_data[i] == col) {
-      return true;
-    }
-  }
-  return false;
+  return FindEntry<IdType>(indptr_data, indices_data, csr.sorted, row, col) >= 0;
 }
 
 template bool CSRIsNonZero<kDLCPU, int32_t>(CSRMatrix, int64_t, int64_t);
@@ -108,17 +232,15 @@ template bool CSRIsNonZero<kDLCPU, int64_t>(CSRMatrix, int64_t, int64_t);
 
 template <DLDeviceType XPU, typename IdType>
 NDArray CSRIsNonZero(CSRMatrix csr, NDArray row, NDArray col) {
-  const auto rowlen = row->shape[0];
-  const auto collen = col->shape[0];
-  const auto rstlen = std::max(rowlen, collen);
-  NDArray rst = NDArray::Empty({rstlen}, row->dtype, row->ctx);
+  const BatchedQuery<IdType> query(csr, row, col);
+  NDArray rst = NDArray::Empty({query.num_queries}, row->dtype, row->ctx);
   IdType* rst_data = static_cast<IdType*>(rst->data);
-  const IdType* row_data = static_cast<IdType*>(row->data);
-  const IdType* col_data = static_cast<IdType*>(col->data);
-  const int64_t row_stride = (rowlen == 1 && collen != 1) ? 0 : 1;
-  const int64_t col_stride = (collen == 1 && rowlen != 1) ? 0 : 1;
-  for (int64_t i = 0, j = 0; i < rowlen && j < collen; i += row_stride, j += col_stride) {
-    *(rst_data++) = CSRIsNonZero<XPU, IdType>(csr, row_data[i], col_data[j])? 1 : 0;
+  const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
+  const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
+#pragma omp parallel for if (query.num_queries >= kQueryGrainSize)
+  for (int64_t i = 0; i < query.num_queries; ++i) {
+    rst_data[i] = FindEntry<IdType>(indptr_data, indices_data, csr.sorted,
+                                    query.Row(i), query.Col(i)) >= 0 ? 1 : 0;
   }
   return rst;
 }
@@ -126,6 +248,25 @@ NDArray CSRIsNonZero(CSRMatrix csr, NDArray row, NDArray col) {
 template NDArray CSRIsNonZero<kDLCPU, int32_t>(CSRMatrix, NDArray, NDArray);
 template NDArray CSRIsNonZero<kDLCPU, int64_t>(CSRMatrix, NDArray, NDArray);
 
+///////////////////////////// CSRIsSorted /////////////////////////////
+
+template <DLDeviceType XPU, typename IdType>
+bool CSRIsSorted(CSRMatrix csr) {
+  const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
+  const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
+  const int64_t nnz = csr.indices->shape[0];
+  bool sorted = true;
+#pragma omp parallel for reduction(&&:sorted) if (nnz >= kParallelGrainSize)
+  for (int64_t row = 0; row < csr.num_rows; ++row) {
+    sorted = sorted && std::is_sorted(indices_data + indptr_data[row],
+                                      indices_data + indptr_data[row + 1]);
+  }
+  return sorted;
+}
+
+template bool CSRIsSorted<kDLCPU, int32_t>(CSRMatrix csr);
+template bool CSRIsSorted<kDLCPU, int64_t>(CSRMatrix csr);
+
 ///////////////////////////// CSRHasDuplicate /////////////////////////////
 
 template <DLDeviceType XPU, typename IdType>
@@ -196,10 +337,13 @@ template NDArray CSRGetRowColumnIndices<kDLCPU, int64_t>(CSRMatrix, int64_t);
 
 template <DLDeviceType XPU, typename IdType, typename DType>
 NDArray CSRGetRowData(CSRMatrix csr, int64_t row) {
-  CHECK(CSRHasData(csr)) << "missing data array";
   CHECK(row >= 0 && row < csr.num_rows) << "Invalid row index: " << row;
   const int64_t len = impl::CSRGetRowNNZ<XPU, IdType>(csr, row);
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
+  if (!CSRHasData(csr)) {
+    return aten::Range(indptr_data[row], indptr_data[row] + len,
+                 csr.indptr->dtype.bits, csr.indptr->ctx);
+  }
   const int64_t offset = indptr_data[row] * sizeof(DType);
   return csr.data.CreateView({len}, csr.data->dtype, offset);
 }
@@ -211,58 +355,82 @@ template NDArray CSRGetRowData<kDLCPU, int64_t, int64_t>(CSRMatrix, int64_t);
 
 template <DLDeviceType XPU, typename IdType, typename DType>
 NDArray CSRGetData(CSRMatrix csr, int64_t row, int64_t col) {
-  CHECK(CSRHasData(csr)) << "missing data array";
-  // TODO(minjie): use more efficient binary search when the column indices is sorted
   CHECK(row >= 0 && row < csr.num_rows) << "Invalid row index: " << row;
   CHECK(col >= 0 && col < csr.num_cols) << "Invalid col index: " << col;
   std::vector<DType> ret_vec;
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
-  const DType* data = static_cast<DType*>(csr.data->data);
-  for (IdType i = indptr_data[row]; i < indptr_data[row+1]; ++i) {
-    if (indices_data[i] == col) {
-      ret_vec.push_back(data[i]);
-    }
-  }
-  return VecToNDArray(ret_vec, csr.data->dtype, csr.data->ctx);
+  const DType* data = CSRHasData(csr) ? static_cast<DType*>(csr.data->data) : nullptr;
+  ForEachEntry<IdType>(indptr_data, indices_data, csr.sorted, row, col, [&] (IdType i) {
+      ret_vec.push_back(data ? data[i] : i);
+    });
+  return VecToNDArray(ret_vec, csr.indptr->dtype, csr.indptr->ctx);
 }
 
 template NDArray CSRGetData<kDLCPU, int32_t, int32_t>(CSRMatrix, int64_t, int64_t);
 template NDArray CSRGetData<kDLCPU, int64_t, int64_t>(CSRMatrix, int64_t, int64_t);
 
-template <DLDeviceType XPU, typename IdType, typename DType>
-NDArray CSRGetData(CSRMatrix csr, NDArray rows, NDArray cols) {
-  CHECK(CSRHasData(csr)) << "missing data array";
-  // TODO(minjie): more efficient implementation for sorted column index
-  const int64_t rowlen = rows->shape[0];
-  const int64_t collen = cols->shape[0];
-
-  CHECK((rowlen == collen) || (rowlen == 1) || (collen == 1))
-    << "Invalid row and col id array.";
-
-  const int64_t row_stride = (rowlen == 1 && collen != 1) ? 0 : 1;
-  const int64_t col_stride = (collen == 1 && rowlen != 1) ? 0 : 1;
-  const IdType* row_data = static_cast<IdType*>(rows->data);
-  const IdType* col_data = static_cast<IdType*>(cols->data);
-
+/*!
+ * \brief Look up the entries of a batch of (row, col) queries in parallel.
+ *
+ * The entries of each query are counted first, so that all the results are
+ * written to arrays of the exact size.
+ *
+ * \param ret_rows Output row index of each entry. Skipped if null.
+ * \param ret_cols Output col index of each entry. Skipped if null.
+ * \param ret_data Output data of each entry.
+ */
+template <typename IdType, typename DType>
+void CSRGetDataBatched(CSRMatrix csr, NDArray rows, NDArray cols,
+                       NDArray* ret_rows, NDArray* ret_cols, NDArray* ret_data) {
+  const BatchedQuery<IdType> query(csr, rows, cols);
+  const int64_t num_queries = query.num_queries;
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
-  const DType* data = static_cast<DType*>(csr.data->data);
-
-  std::vector<DType> ret_vec;
-
-  for (int64_t i = 0, j = 0; i < rowlen && j < collen; i += row_stride, j += col_stride) {
-    const IdType row_id = row_data[i], col_id = col_data[j];
-    CHECK(row_id >= 0 && row_id < csr.num_rows) << "Invalid row index: " << row_id;
-    CHECK(col_id >= 0 && col_id < csr.num_cols) << "Invalid col index: " << col_id;
-    for (IdType i = indptr_data[row_id]; i < indptr_data[row_id+1]; ++i) {
-      if (indices_data[i] == col_id) {
-          ret_vec.push_back(data[i]);
-      }
-    }
+  const DType* data = CSRHasData(csr) ? static_cast<DType*>(csr.data->data) : nullptr;
+
+  // offsets[i] is the position of the first entry of query i in the result
+  std::vector<int64_t> offsets(num_queries + 1, 0);
+#pragma omp parallel for if (num_queries >= kQueryGrainSize)
+  for (int64_t i = 0; i < num_queries; ++i) {
+    int64_t count = 0;
+    ForEachEntry<IdType>(indptr_data, indices_data, csr.sorted, query.Row(i), query.Col(i),
+                         [&count] (IdType) { ++count; });
+    offsets[i] = count;
+  }
+  const int64_t total = ExclusiveScan(offsets.data(), num_queries + 1);
+
+  *ret_data = NDArray::Empty({total}, csr.indptr->dtype, csr.indptr->ctx);
+  DType* ret_data_ptr = static_cast<DType*>((*ret_data)->data);
+  IdType* ret_rows_ptr = nullptr;
+  IdType* ret_cols_ptr = nullptr;
+  if (ret_rows) {
+    *ret_rows = NDArray::Empty({total}, csr.indptr->dtype, csr.indptr->ctx);
+    ret_rows_ptr = static_cast<IdType*>((*ret_rows)->data);
+  }
+  if (ret_cols) {
+    *ret_cols = NDArray::Empty({total}, csr.indptr->dtype, csr.indptr->ctx);
+    ret_cols_ptr = static_cast<IdType*>((*ret_cols)->data);
+  }
+#pragma omp parallel for if (num_queries >= kQueryGrainSize)
+  for (int64_t i = 0; i < num_queries; ++i) {
+    const IdType row_id = query.Row(i), col_id = query.Col(i);
+    int64_t pos = offsets[i];
+    ForEachEntry<IdType>(indptr_data, indices_data, csr.sorted, row_id, col_id,
+                         [&] (IdType k) {
+        if (ret_rows_ptr) ret_rows_ptr[pos] = row_id;
+        if (ret_cols_ptr) ret_cols_ptr[pos] = col_id;
+        ret_data_ptr[pos] = data ? data[k] : k;
+        ++pos;
+      });
   }
+}
 
-  return VecToNDArray(ret_vec, csr.data->dtype, csr.data->ctx);
+template <DLDeviceType XPU, typename IdType, typename DType>
+NDArray CSRGetData(CSRMatrix csr, NDArray rows, NDArray cols) {
+  NDArray ret_data;
+  CSRGetDataBatched<IdType, DType>(csr, rows, cols, nullptr, nullptr, &ret_data);
+  return ret_data;
 }
 
 template NDArray CSRGetData<kDLCPU, int32_t, int32_t>(CSRMatrix csr, NDArray rows, NDArray cols);
@@ -272,43 +440,9 @@ template NDArray CSRGetData<kDLCPU, int64_t, int64_t>(CSRMatrix csr, NDArray row
 
 template <DLDeviceType XPU, typename IdType, typename DType>
 std::vector<NDArray> CSRGetDataAndIndices(CSRMatrix csr, NDArray rows, NDArray cols) {
-  CHECK(CSRHasData(csr)) << "missing data array";
-  // TODO(minjie): more efficient implementation for matrix without duplicate entries
-  // TODO(minjie): more efficient implementation for sorted column index
-  const int64_t rowlen = rows->shape[0];
-  const int64_t collen = cols->shape[0];
-
-  CHECK((rowlen == collen) || (rowlen == 1) || (collen == 1))
-    << "Invalid row and col id array.";
-
-  const int64_t row_stride = (rowlen == 1 && collen != 1) ? 0 : 1;
-  const int64_t col_stride = (collen == 1 && rowlen != 1) ? 0 : 1;
-  const IdType* row_data = static_cast<IdType*>(rows->data);
-  const IdType* col_data = static_cast<IdType*>(cols->data);
-
-  const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
-  const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
-  const DType* data = static_cast<DType*>(csr.data->data);
-
-  std::vector<IdType> ret_rows, ret_cols;
-  std::vector<DType> ret_data;
-
-  for (int64_t i = 0, j = 0; i < rowlen && j < collen; i += row_stride, j += col_stride) {
-    const IdType row_id = row_data[i], col_id = col_data[j];
-    CHECK(row_id >= 0 && row_id < csr.num_rows) << "Invalid row index: " << row_id;
-    CHECK(col_id >= 0 && col_id < csr.num_cols) << "Invalid col index: " << col_id;
-    for (IdType i = indptr_data[row_id]; i < indptr_data[row_id+1]; ++i) {
-      if (indices_data[i] == col_id) {
-          ret_rows.push_back(row_id);
-          ret_cols.push_back(col_id);
-          ret_data.push_back(data[i]);
-      }
-    }
-  }
-
-  return {VecToIdArray(ret_rows, csr.indptr->dtype.bits, csr.indptr->ctx),
-          VecToIdArray(ret_cols, csr.indptr->dtype.bits, csr.indptr->ctx),
-          VecToNDArray(ret_data, csr.data->dtype, csr.data->ctx)};
+  NDArray ret_rows, ret_cols, ret_data;
+  CSRGetDataBatched<IdType, DType>(csr, rows, cols, &ret_rows, &ret_cols, &ret_data);
+  return {ret_rows, ret_cols, ret_data};
 }
 
 template std::vector<NDArray> CSRGetDataAndIndices<kDLCPU, int32_t, int32_t>(
@@ -320,22 +454,52 @@ template std::vector<NDArray> CSRGetDataAndIndices<kDLCPU, int64_t, int64_t>(
 
 // for a matrix of shape (N, M) and NNZ
 // complexity: time O(NNZ + max(N, M)), space O(1)
+// Large matrices are transposed in parallel using O(NNZ) extra space.
 template <DLDeviceType XPU, typename IdType, typename DType>
 CSRMatrix CSRTranspose(CSRMatrix csr) {
-  CHECK(CSRHasData(csr)) << "missing data array is currently not allowed in CSRTranspose.";
   const int64_t N = csr.num_rows;
   const int64_t M = csr.num_cols;
   const int64_t nnz = csr.indices->shape[0];
   const IdType* Ap = static_cast<IdType*>(csr.indptr->data);
   const IdType* Aj = static_cast<IdType*>(csr.indices->data);
-  const DType* Ax = static_cast<DType*>(csr.data->data);
+  // without a data array, the data of an entry is its position
+  const DType* Ax = CSRHasData(csr) ? static_cast<DType*>(csr.data->data) : nullptr;
   NDArray ret_indptr = NDArray::Empty({M + 1}, csr.indptr->dtype, csr.indptr->ctx);
   NDArray ret_indices = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
-  NDArray ret_data = NDArray::Empty({nnz}, csr.data->dtype, csr.data->ctx);
+  NDArray ret_data = NDArray::Empty({nnz}, csr.indptr->dtype, csr.indptr->ctx);
   IdType* Bp = static_cast<IdType*>(ret_indptr->data);
   IdType* Bi = static_cast<IdType*>(ret_indices->data);
   DType* Bx = static_cast<DType*>(ret_data->data);
 
+  if (nnz >= kParallelGrainSize && omp_get_max_threads() > 1) {
+    ComputeIndptr(nnz, Aj, M, Bp);
+    std::vector<int64_t> bucket_cols;
+    const std::vector<IdType> buf = BucketByKey(
+        nnz, Bp, M, [Aj] (int64_t j) { return Aj[j]; }, &bucket_cols);
+    // Sort each bucket by column. Within a bucket, the entries are in the
+    // original order, so the rows are non-decreasing and the result is the
+    // same as the sequential version below.
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < static_cast<int64_t>(bucket_cols.size()) - 1; ++b) {
+      const int64_t col_begin = bucket_cols[b], col_end = bucket_cols[b + 1];
+      if (Bp[col_begin] == Bp[col_end]) {
+        continue;
+      }
+      std::vector<IdType> pos(Bp + col_begin, Bp + col_end);
+      int64_t row = std::upper_bound(Ap, Ap + N + 1, buf[Bp[col_begin]]) - Ap - 1;
+      for (IdType k = Bp[col_begin]; k < Bp[col_end]; ++k) {
+        const IdType j = buf[k];
+        if (j >= Ap[row + 1]) {
+          row = std::upper_bound(Ap + row + 1, Ap + N + 1, j) - Ap - 1;
+        }
+        const IdType dst = pos[Aj[j] - col_begin]++;
+        Bi[dst] = row;
+        Bx[dst] = Ax ? Ax[j] : j;
+      }
+    }
+    return CSRMatrix{csr.num_cols, csr.num_rows, ret_indptr, ret_indices, ret_data, true};
+  }
+
   std::fill(Bp, Bp + M, 0);
 
   for (int64_t j = 0; j < nnz; ++j) {
@@ -354,7 +518,7 @@ CSRMatrix CSRTranspose(CSRMatrix csr) {
     for (IdType j = Ap[i]; j < Ap[i+1]; ++j) {
       const IdType dst = Aj[j];
       Bi[Bp[dst]] = i;
-      Bx[Bp[dst]] = Ax[j];
+      Bx[Bp[dst]] = Ax ? Ax[j] : j;
       Bp[dst]++;
     }
   }
@@ -366,7 +530,7 @@ CSRMatrix CSRTranspose(CSRMatrix csr) {
     last = temp;
   }
 
-  return CSRMatrix{csr.num_cols, csr.num_rows, ret_indptr, ret_indices, ret_data};
+  return CSRMatrix{csr.num_cols, csr.num_rows, ret_indptr, ret_indices, ret_data, true};
 }
 
 template CSRMatrix CSRTranspose<kDLCPU, int32_t, int32_t>(CSRMatrix csr);
@@ -379,6 +543,7 @@ COOMatrix CSRToCOO(CSRMatrix csr) {
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
   NDArray ret_row = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
   IdType* ret_row_data = static_cast<IdType*>(ret_row->data);
+#pragma omp parallel for if (nnz >= kParallelGrainSize)
   for (IdType i = 0; i < csr.indptr->shape[0] - 1; ++i) {
     std::fill(ret_row_data + indptr_data[i],
               ret_row_data + indptr_data[i + 1],
@@ -393,7 +558,12 @@ template COOMatrix CSRToCOO<kDLCPU, int64_t>(CSRMatrix csr);
 // complexity: time O(NNZ), space O(1)
 template <DLDeviceType XPU, typename IdType>
 COOMatrix CSRToCOODataAsOrder(CSRMatrix csr) {
-  CHECK(CSRHasData(csr)) << "missing data array.";
+  if (!CSRHasData(csr)) {
+    // the entries are already in the order of their data
+    COOMatrix coo = CSRToCOO<XPU, IdType>(csr);
+    coo.data = NDArray();
+    return coo;
+  }
   const int64_t N = csr.num_rows;
   const int64_t M = csr.num_cols;
   const int64_t nnz = csr.indices->shape[0];
@@ -429,23 +599,26 @@ template COOMatrix CSRToCOODataAsOrder<kDLCPU, int64_t>(CSRMatrix csr);
 
 template <DLDeviceType XPU, typename IdType, typename DType>
 CSRMatrix CSRSliceRows(CSRMatrix csr, int64_t start, int64_t end) {
-  CHECK(CSRHasData(csr)) << "missing data array.";
   const IdType* indptr = static_cast<IdType*>(csr.indptr->data);
   const int64_t num_rows = end - start;
   const int64_t nnz = indptr[end] - indptr[start];
   CSRMatrix ret;
+  ret.sorted = csr.sorted;
   ret.num_rows = num_rows;
   ret.num_cols = csr.num_cols;
   ret.indptr = NDArray::Empty({num_rows + 1}, csr.indptr->dtype, csr.indices->ctx);
   ret.indices = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
-  ret.data = NDArray::Empty({nnz}, csr.data->dtype, csr.data->ctx);
   IdType* r_indptr = static_cast<IdType*>(ret.indptr->data);
   for (int64_t i = start; i < end + 1; ++i) {
     r_indptr[i - start] = indptr[i] - indptr[start];
   }
   // indices and data can be view arrays
   ret.indices = csr.indices.CreateView({nnz}, csr.indices->dtype, indptr[start] * sizeof(IdType));
-  ret.data = csr.data.CreateView({nnz}, csr.data->dtype, indptr[start] * sizeof(DType));
+  if (CSRHasData(csr)) {
+    ret.data = csr.data.CreateView({nnz}, csr.data->dtype, indptr[start] * sizeof(DType));
+  } else if (indptr[start] != 0) {
+    ret.data = aten::Range(indptr[start], indptr[end], csr.indptr->dtype.bits, csr.indptr->ctx);
+  }
   return ret;
 }
 
@@ -454,10 +627,9 @@ template CSRMatrix CSRSliceRows<kDLCPU, int64_t, int64_t>(CSRMatrix, int64_t, in
 
 template <DLDeviceType XPU, typename IdType, typename DType>
 CSRMatrix CSRSliceRows(CSRMatrix csr, NDArray rows) {
-  CHECK(CSRHasData(csr)) << "missing data array.";
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
-  const DType* data = static_cast<DType*>(csr.data->data);
+  const DType* data = CSRHasData(csr) ? static_cast<DType*>(csr.data->data) : nullptr;
   const auto len = rows->shape[0];
   const IdType* rows_data = static_cast<IdType*>(rows->data);
   int64_t nnz = 0;
@@ -467,11 +639,12 @@ CSRMatrix CSRSliceRows(CSRMatrix csr, NDArray rows) {
   }
 
   CSRMatrix ret;
+  ret.sorted = csr.sorted;
   ret.num_rows = len;
   ret.num_cols = csr.num_cols;
   ret.indptr = NDArray::Empty({len + 1}, csr.indptr->dtype, csr.indices->ctx);
   ret.indices = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
-  ret.data = NDArray::Empty({nnz}, csr.data->dtype, csr.data->ctx);
+  ret.data = NDArray::Empty({nnz}, csr.indptr->dtype, csr.indptr->ctx);
 
   IdType* ret_indptr_data = static_cast<IdType*>(ret.indptr->data);
   IdType* ret_indices_data = static_cast<IdType*>(ret.indices->data);
@@ -483,8 +656,13 @@ CSRMatrix CSRSliceRows(CSRMatrix csr, NDArray rows) {
     ret_indptr_data[i + 1] = ret_indptr_data[i] + indptr_data[rid + 1] - indptr_data[rid];
     std::copy(indices_data + indptr_data[rid], indices_data + indptr_data[rid + 1],
               ret_indices_data + ret_indptr_data[i]);
-    std::copy(data + indptr_data[rid], data + indptr_data[rid + 1],
-              ret_data + ret_indptr_data[i]);
+    if (data) {
+      std::copy(data + indptr_data[rid], data + indptr_data[rid + 1],
+                ret_data + ret_indptr_data[i]);
+    } else {
+      std::iota(ret_data + ret_indptr_data[i], ret_data + ret_indptr_data[i + 1],
+                indptr_data[rid]);
+    }
   }
   return ret;
 }
@@ -496,51 +674,60 @@ template CSRMatrix CSRSliceRows<kDLCPU, int64_t, int64_t>(CSRMatrix , NDArray);
 
 template <DLDeviceType XPU, typename IdType, typename DType>
 CSRMatrix CSRSliceMatrix(CSRMatrix csr, runtime::NDArray rows, runtime::NDArray cols) {
-  CHECK(CSRHasData(csr)) << "missing data array.";
-  IdHashMap<IdType> hashmap(cols);
   const int64_t new_nrows = rows->shape[0];
   const int64_t new_ncols = cols->shape[0];
   const IdType* rows_data = static_cast<IdType*>(rows->data);
+  const IdType* cols_data = static_cast<IdType*>(cols->data);
+  IdMap<IdType> col_map(csr.num_cols, new_ncols);
+  for (int64_t j = 0; j < new_ncols; ++j) {
+    CHECK(cols_data[j] >= 0 && cols_data[j] < csr.num_cols)
+      << "Invalid col index: " << cols_data[j];
+    col_map.Insert(cols_data[j]);
+  }
+  for (int64_t i = 0; i < new_nrows; ++i) {
+    CHECK(rows_data[i] >= 0 && rows_data[i] < csr.num_rows)
+      << "Invalid row index: " << rows_data[i];
+  }
 
   const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
-  const DType* data = static_cast<DType*>(csr.data->data);
-
-  std::vector<IdType> sub_indptr, sub_indices;
-  std::vector<DType> sub_data;
-  sub_indptr.resize(new_nrows + 1, 0);
-  const IdType kInvalidId = new_ncols + 1;
+  const DType* data = CSRHasData(csr) ? static_cast<DType*>(csr.data->data) : nullptr;
+  const IdType kInvalidId = -1;
+  // the rows are scanned twice: to count the entries of each new row, then
+  // to fill them in
+  const bool parallel = new_nrows >= kQueryGrainSize;
+  NDArray sub_indptr = NDArray::Empty({new_nrows + 1}, csr.indptr->dtype, csr.indptr->ctx);
+  IdType* sub_indptr_data = static_cast<IdType*>(sub_indptr->data);
+#pragma omp parallel for schedule(dynamic, 64) if (parallel)
+  for (int64_t i = 0; i < new_nrows; ++i) {
+    const IdType oldi = rows_data[i];
+    IdType count = 0;
+    for (IdType p = indptr_data[oldi]; p < indptr_data[oldi + 1]; ++p) {
+      count += (col_map.Map(indices_data[p], kInvalidId) != kInvalidId);
+    }
+    sub_indptr_data[i] = count;
+  }
+  sub_indptr_data[new_nrows] = 0;
+  const int64_t nnz = ExclusiveScan(sub_indptr_data, new_nrows + 1);
+
+  NDArray sub_indices = NDArray::Empty({nnz}, csr.indptr->dtype, csr.indptr->ctx);
+  NDArray sub_data = NDArray::Empty({nnz}, csr.indptr->dtype, csr.indptr->ctx);
+  IdType* sub_indices_data = static_cast<IdType*>(sub_indices->data);
+  DType* sub_data_data = static_cast<DType*>(sub_data->data);
+#pragma omp parallel for schedule(dynamic, 64) if (parallel)
   for (int64_t i = 0; i < new_nrows; ++i) {
-    // NOTE: newi == i
     const IdType oldi = rows_data[i];
-    CHECK(oldi >= 0 && oldi < csr.num_rows) << "Invalid row index: " << oldi;
+    IdType pos = sub_indptr_data[i];
     for (IdType p = indptr_data[oldi]; p < indptr_data[oldi + 1]; ++p) {
-      const IdType oldj = indices_data[p];
-      const IdType newj = hashmap.Map(oldj, kInvalidId);
+      const IdType newj = col_map.Map(indices_data[p], kInvalidId);
       if (newj != kInvalidId) {
-        ++sub_indptr[i];
-        sub_indices.push_back(newj);
-        sub_data.push_back(data[p]);
+        sub_indices_data[pos] = newj;
+        sub_data_data[pos] = data ? data[p] : p;
+        ++pos;
       }
     }
   }
-
-  // cumsum sub_indptr
-  for (int64_t i = 0, cumsum = 0; i < new_nrows; ++i) {
-    const IdType temp = sub_indptr[i];
-    sub_indptr[i] = cumsum;
-    cumsum += temp;
-  }
-  sub_indptr[new_nrows] = sub_indices.size();
-
-  const int64_t nnz = sub_data.size();
-  NDArray sub_data_arr = NDArray::Empty({nnz}, csr.data->dtype, csr.data->ctx);
-  DType* ptr = static_cast<DType*>(sub_data_arr->data);
-  std::copy(sub_data.begin(), sub_data.end(), ptr);
-  return CSRMatrix{new_nrows, new_ncols,
-    VecToIdArray(sub_indptr, csr.indptr->dtype.bits, csr.indptr->ctx),
-    VecToIdArray(sub_indices, csr.indptr->dtype.bits, csr.indptr->ctx),
-    sub_data_arr};
+  return CSRMatrix{new_nrows, new_ncols, sub_indptr, sub_indices, sub_data};
 }
 
 template CSRMatrix CSRSliceMatrix<kDLCPU, int32_t, int32_t>(
@@ -573,6 +760,7 @@ template bool COOHasDuplicate<kDLCPU, int64_t>(COOMatrix coo);
 ///////////////////////////// COOToCSR /////////////////////////////
 
 // complexity: time O(NNZ), space O(1)
+// Large matrices are converted in parallel using O(NNZ) extra space.
 template <DLDeviceType XPU, typename IdType, typename DType>
 CSRMatrix COOToCSR(COOMatrix coo) {
   const int64_t N = coo.num_rows;
@@ -592,6 +780,34 @@ CSRMatrix COOToCSR(COOMatrix coo) {
   IdType* Bp = static_cast<IdType*>(ret_indptr->data);
   IdType* Bi = static_cast<IdType*>(ret_indices->data);
 
+  if (NNZ >= kParallelGrainSize && omp_get_max_threads() > 1) {
+    ComputeIndptr(NNZ, row_data, N, Bp);
+    std::vector<int64_t> bucket_rows;
+    const std::vector<IdType> buf = BucketByKey(
+        NNZ, Bp, N, [row_data] (int64_t i) { return row_data[i]; }, &bucket_rows);
+    const DType* data = COOHasData(coo) ? static_cast<DType*>(coo.data->data) : nullptr;
+    DType* Bx = static_cast<DType*>(ret_data->data);
+    IdType* Bx_shuffle = static_cast<IdType*>(ret_data->data);
+    // Sort each bucket by row. Within a bucket, the entries are in the original
+    // order, so the result is the same as the sequential version below.
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < static_cast<int64_t>(bucket_rows.size()) - 1; ++b) {
+      const int64_t row_begin = bucket_rows[b], row_end = bucket_rows[b + 1];
+      std::vector<IdType> pos(Bp + row_begin, Bp + row_end);
+      for (IdType k = Bp[row_begin]; k < Bp[row_end]; ++k) {
+        const IdType i = buf[k];
+        const IdType dst = pos[row_data[i] - row_begin]++;
+        Bi[dst] = col_data[i];
+        if (data) {
+          Bx[dst] = data[i];
+        } else {
+          Bx_shuffle[dst] = i;
+        }
+      }
+    }
+    return CSRMatrix{coo.num_rows, coo.num_cols, ret_indptr, ret_indices, ret_data};
+  }
+
   std::fill(Bp, Bp + N, 0);
 
   for (int64_t i = 0; i < NNZ; ++i) {
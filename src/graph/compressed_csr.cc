@@ -0,0 +1,365 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file graph/compressed_csr.cc
+ * \brief Compressed CSR implementation
+ */
+#include "./compressed_csr.h"
+
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include "../array/common.h"  // for ATEN_ID_TYPE_SWITCH
+#include "../array/cpu/parallel_util.h"
+
+namespace dgl {
+
+using aten::impl::kParallelGrainSize;
+using aten::impl::ThreadRange;
+
+namespace {
+
+// Zero bytes appended to the encoded data so that the bit unpacking can
+//   always load a whole word.
+constexpr size_t kPadding = 16;
+
+inline uint64_t ZigZag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline uint64_t UnZigZag(uint64_t v) {
+  return (v >> 1) ^ (~(v & 1) + 1);
+}
+
+inline void PutVarint(uint64_t v, std::vector<uint8_t>* out) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(v));
+}
+
+inline const uint8_t* GetVarint(const uint8_t* p, uint64_t* v) {
+  uint64_t ret = 0;
+  int shift = 0;
+  while (*p & 0x80) {
+    ret |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+    shift += 7;
+  }
+  *v = ret | (static_cast<uint64_t>(*p++) << shift);
+  return p;
+}
+
+inline int BitWidth(uint64_t v) {
+  int width = 0;
+  while (v) {
+    ++width;
+    v >>= 1;
+  }
+  return width;
+}
+
+// Append n values of the given bit width, least significant bit first.
+void PackBits(const uint64_t* vals, int64_t n, int width, std::vector<uint8_t>* out) {
+  const size_t start = out->size();
+  out->resize(start + (n * width + 7) / 8, 0);
+  uint8_t* p = out->data() + start;
+  uint64_t pos = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    uint64_t v = vals[i];
+    for (int left = width; left > 0;) {
+      const int off = pos & 7;
+      const int take = std::min(8 - off, left);
+      p[pos >> 3] |= static_cast<uint8_t>((v & ((1u << take) - 1)) << off);
+      v >>= take;
+      pos += take;
+      left -= take;
+    }
+  }
+}
+
+// Read the value of the given bit width starting at bit pos.
+// Assumes at least 9 readable bytes from the word. The bytes are assembled in
+//   little-endian order whatever the host order is, matching PackBits.
+inline uint64_t LoadBits(const uint8_t* p, uint64_t pos, int width) {
+  const uint8_t* q = p + (pos >> 3);
+  uint64_t word = 0;
+  for (int i = 0; i < 8; ++i) {
+    word |= static_cast<uint64_t>(q[i]) << (8 * i);
+  }
+  const int shift = pos & 7;
+  uint64_t val = word >> shift;
+  if (shift + width > 64) {
+    val |= static_cast<uint64_t>(q[8]) << (64 - shift);
+  }
+  return (width == 64) ? val : val & ((static_cast<uint64_t>(1) << width) - 1);
+}
+
+// Encode a list of n ids. The first id is stored relative to base.
+template <typename IdType>
+void EncodeList(const IdType* vals, int64_t n, int64_t base, std::vector<uint8_t>* out) {
+  if (n == 0) {
+    return;
+  }
+  PutVarint(ZigZag(static_cast<int64_t>(vals[0]) - base), out);
+  const bool sorted = std::is_sorted(vals, vals + n);
+  uint64_t codes[CompressedCSR::kBlockSize];
+  for (int64_t i = 1; i < n; i += CompressedCSR::kBlockSize) {
+    const int64_t m = std::min(CompressedCSR::kBlockSize, n - i);
+    uint64_t min_code = std::numeric_limits<uint64_t>::max(), max_code = 0;
+    for (int64_t j = 0; j < m; ++j) {
+      const int64_t delta =
+        static_cast<int64_t>(vals[i + j]) - static_cast<int64_t>(vals[i + j - 1]);
+      codes[j] = sorted ? static_cast<uint64_t>(delta) : ZigZag(delta);
+      min_code = std::min(min_code, codes[j]);
+      max_code = std::max(max_code, codes[j]);
+    }
+    for (int64_t j = 0; j < m; ++j) {
+      codes[j] -= min_code;
+    }
+    // block header: bit width, with the top bit marking zigzag-encoded deltas
+    const int width = BitWidth(max_code - min_code);
+    out->push_back(static_cast<uint8_t>(width | (sorted ? 0 : 0x80)));
+    PutVarint(min_code, out);
+    PackBits(codes, m, width, out);
+  }
+}
+
+// Decode a list of n ids encoded by EncodeList.
+template <typename IdType>
+void DecodeList(const uint8_t* p, int64_t n, int64_t base, IdType* out) {
+  if (n == 0) {
+    return;
+  }
+  uint64_t code;
+  p = GetVarint(p, &code);
+  // unsigned arithmetic wraps around, which is what we want for negative deltas
+  uint64_t prev = static_cast<uint64_t>(base) + UnZigZag(code);
+  out[0] = static_cast<IdType>(prev);
+  for (int64_t i = 1; i < n; i += CompressedCSR::kBlockSize) {
+    const int64_t m = std::min(CompressedCSR::kBlockSize, n - i);
+    const uint8_t header = *p++;
+    const int width = header & 0x7f;
+    uint64_t min_code;
+    p = GetVarint(p, &min_code);
+    if (width == 0) {
+      const uint64_t delta = (header & 0x80) ? UnZigZag(min_code) : min_code;
+      for (int64_t j = 0; j < m; ++j) {
+        prev += delta;
+        out[i + j] = static_cast<IdType>(prev);
+      }
+    } else if (header & 0x80) {
+      for (int64_t j = 0; j < m; ++j) {
+        prev += UnZigZag(min_code + LoadBits(p, j * width, width));
+        out[i + j] = static_cast<IdType>(prev);
+      }
+    } else {
+      for (int64_t j = 0; j < m; ++j) {
+        prev += min_code + LoadBits(p, j * width, width);
+        out[i + j] = static_cast<IdType>(prev);
+      }
+    }
+    p += (m * width + 7) / 8;
+  }
+}
+
+// Encode every row of a CSR-shaped array in parallel. The first id of a row is
+//   stored relative to the row id if row_base is true, otherwise relative to
+//   the position of the row.
+// The rows are written in blocks of kRowsPerBlock rows. A block is the bit width
+//   of the row offsets, the offsets of all but its first row relative to the
+//   end of the offsets, and the encoded rows. The byte offset of each block is
+//   written to block_offsets.
+template <typename IdType>
+void EncodeRows(int64_t num_rows, const IdType* indptr, const IdType* vals, bool row_base,
+                std::vector<uint8_t>* data, std::vector<uint64_t>* block_offsets) {
+  const int64_t num_blocks = (num_rows + CompressedCSR::kRowsPerBlock - 1)
+    / CompressedCSR::kRowsPerBlock;
+  block_offsets->resize(num_blocks);
+  const int max_threads = (indptr[num_rows] >= kParallelGrainSize) ? omp_get_max_threads() : 1;
+  std::vector<std::vector<uint8_t>> chunks(max_threads);
+  int nthreads = 1;
+  // each thread encodes a range of blocks into its own buffer
+#pragma omp parallel num_threads(max_threads)
+  {
+    const int tid = omp_get_thread_num();
+    if (tid == 0) {
+      nthreads = omp_get_num_threads();
+    }
+    int64_t begin, end;
+    ThreadRange(num_blocks, tid, omp_get_num_threads(), &begin, &end);
+    std::vector<uint8_t>& chunk = chunks[tid];
+    std::vector<uint8_t> rows;
+    uint64_t row_offsets[CompressedCSR::kRowsPerBlock];
+    for (int64_t block = begin; block < end; ++block) {
+      const int64_t first = block * CompressedCSR::kRowsPerBlock;
+      const int64_t n = std::min(CompressedCSR::kRowsPerBlock, num_rows - first);
+      rows.clear();
+      for (int64_t i = 0; i < n; ++i) {
+        const int64_t row = first + i;
+        row_offsets[i] = rows.size();
+        EncodeList(vals + indptr[row], indptr[row + 1] - indptr[row],
+                   row_base ? row : static_cast<int64_t>(indptr[row]), &rows);
+      }
+      // the offsets are increasing, so the last one is the largest
+      const int width = BitWidth(row_offsets[n - 1]);
+      (*block_offsets)[block] = chunk.size();
+      chunk.push_back(static_cast<uint8_t>(width));
+      PackBits(row_offsets + 1, n - 1, width, &chunk);
+      chunk.insert(chunk.end(), rows.begin(), rows.end());
+    }
+  }
+  // concatenate the buffers
+  std::vector<uint64_t> chunk_start(nthreads + 1, 0);
+  for (int t = 0; t < nthreads; ++t) {
+    chunk_start[t + 1] = chunk_start[t] + chunks[t].size();
+  }
+  data->assign(chunk_start[nthreads] + kPadding, 0);
+#pragma omp parallel for num_threads(nthreads)
+  for (int t = 0; t < nthreads; ++t) {
+    std::copy(chunks[t].begin(), chunks[t].end(), data->begin() + chunk_start[t]);
+    std::vector<uint8_t>().swap(chunks[t]);
+    int64_t begin, end;
+    ThreadRange(num_blocks, t, nthreads, &begin, &end);
+    for (int64_t block = begin; block < end; ++block) {
+      (*block_offsets)[block] += chunk_start[t];
+    }
+  }
+}
+
+// Locate the encoded row in the data written by EncodeRows.
+inline const uint8_t* FindRow(const std::vector<uint8_t>& data,
+                              const std::vector<uint64_t>& block_offsets,
+                              int64_t num_rows, int64_t row) {
+  const int64_t block = row / CompressedCSR::kRowsPerBlock;
+  const int64_t i = row % CompressedCSR::kRowsPerBlock;
+  const int64_t n = std::min(CompressedCSR::kRowsPerBlock,
+                             num_rows - block * CompressedCSR::kRowsPerBlock);
+  const uint8_t* p = data.data() + block_offsets[block];
+  const int width = *p++;
+  const uint8_t* rows = p + ((n - 1) * width + 7) / 8;
+  return (i == 0) ? rows : rows + LoadBits(p, (i - 1) * width, width);
+}
+
+template <typename IdType>
+bool IsIdentity(const IdType* data, int64_t len) {
+  bool ret = true;
+#pragma omp parallel for reduction(&&:ret) if (len >= kParallelGrainSize)
+  for (int64_t i = 0; i < len; ++i) {
+    ret = ret && (data[i] == static_cast<IdType>(i));
+  }
+  return ret;
+}
+
+// Decode the rows of the compressed csr into the uncompressed arrays.
+template <typename IdType>
+void DecodeAllRows(const CompressedCSR* csr, IdType* indices, IdType* edge_ids) {
+#pragma omp parallel for if (csr->NumEdges() >= kParallelGrainSize)
+  for (int64_t row = 0; row < csr->NumRows(); ++row) {
+    const int64_t start = csr->RowStart(row);
+    csr->DecodeRow<IdType>(row, indices + start, edge_ids ? edge_ids + start : nullptr);
+  }
+}
+
+}  // namespace
+
+constexpr int64_t CompressedCSR::kBlockSize;
+constexpr int64_t CompressedCSR::kRowsPerBlock;
+
+CompressedCSR::CompressedCSR(CSRPtr csr) {
+  CHECK_EQ(csr->Context().device_type, kDLCPU) << "Compressed CSR only supports CPU graphs.";
+  const aten::CSRMatrix adj = csr->ToCSRMatrix();
+  indptr_ = adj.indptr;
+  num_rows_ = adj.num_rows;
+  num_cols_ = adj.num_cols;
+  is_multigraph_ = csr->IsMultigraph();
+  ATEN_ID_TYPE_SWITCH(indptr_->dtype, IdType, {
+    const IdType* indptr = static_cast<IdType*>(adj.indptr->data);
+    const IdType* indices = static_cast<IdType*>(adj.indices->data);
+    EncodeRows(num_rows_, indptr, indices, true, &col_data_, &col_offsets_);
+    // implicit edge ids are the identity
+    const IdType* edge_ids = aten::CSRHasData(adj) ? static_cast<IdType*>(adj.data->data) : nullptr;
+    if (edge_ids && !IsIdentity(edge_ids, adj.data->shape[0])) {
+      EncodeRows(num_rows_, indptr, edge_ids, false, &eid_data_, &eid_offsets_);
+    }
+  });
+}
+
+template <typename IdType>
+void CompressedCSR::DecodeRow(int64_t row, IdType* indices, IdType* edge_ids) const {
+  const int64_t start = RowStart(row);
+  const int64_t len = RowStart(row + 1) - start;
+  if (indices) {
+    DecodeList(FindRow(col_data_, col_offsets_, num_rows_, row), len, row, indices);
+  }
+  if (edge_ids) {
+    if (HasIdentityEdgeIds()) {
+      std::iota(edge_ids, edge_ids + len, static_cast<IdType>(start));
+    } else {
+      DecodeList(FindRow(eid_data_, eid_offsets_, num_rows_, row), len, start, edge_ids);
+    }
+  }
+}
+
+template void CompressedCSR::DecodeRow<int32_t>(int64_t, int32_t*, int32_t*) const;
+template void CompressedCSR::DecodeRow<int64_t>(int64_t, int64_t*, int64_t*) const;
+template void CompressedCSR::DecodeRow<dgl_id_t>(int64_t, dgl_id_t*, dgl_id_t*) const;
+
+DGLIdIters CompressedCSR::SuccVec(int64_t row) const {
+  auto succ = std::make_shared<std::vector<dgl_id_t>>(RowNNZ(row));
+  DecodeRow<dgl_id_t>(row, succ->data(), nullptr);
+  return DGLIdIters(succ);
+}
+
+DGLIdIters CompressedCSR::OutEdgeVec(int64_t row) const {
+  auto eids = std::make_shared<std::vector<dgl_id_t>>(RowNNZ(row));
+  DecodeRow<dgl_id_t>(row, nullptr, eids->data());
+  return DGLIdIters(eids);
+}
+
+EdgeArray CompressedCSR::OutEdges(int64_t row) const {
+  CHECK(row >= 0 && row < num_rows_) << "invalid vertex: " << row;
+  const DLContext ctx{kDLCPU, 0};
+  const int64_t len = RowNNZ(row);
+  IdArray dst = aten::NewIdArray(len, ctx, NumBits());
+  IdArray eid = aten::NewIdArray(len, ctx, NumBits());
+  ATEN_ID_TYPE_SWITCH(indptr_->dtype, IdType, {
+    DecodeRow<IdType>(row, static_cast<IdType*>(dst->data), static_cast<IdType*>(eid->data));
+  });
+  return EdgeArray{aten::Full(row, len, NumBits(), ctx), dst, eid};
+}
+
+DegreeArray CompressedCSR::OutDegrees(IdArray rows) const {
+  const int64_t len = rows->shape[0];
+  DegreeArray rst = DegreeArray::Empty({len}, rows->dtype, rows->ctx);
+  ATEN_ID_TYPE_SWITCH(rows->dtype, IdType, {
+    const IdType* rows_data = static_cast<IdType*>(rows->data);
+    IdType* rst_data = static_cast<IdType*>(rst->data);
+    for (int64_t i = 0; i < len; ++i) {
+      rst_data[i] = RowNNZ(rows_data[i]);
+    }
+  });
+  return rst;
+}
+
+CSRPtr CompressedCSR::Decompress() const {
+  const DLContext ctx{kDLCPU, 0};
+  const int64_t nnz = NumEdges();
+  IdArray indices = aten::NewIdArray(nnz, ctx, NumBits());
+  IdArray edge_ids = HasIdentityEdgeIds() ? IdArray() : aten::NewIdArray(nnz, ctx, NumBits());
+  ATEN_ID_TYPE_SWITCH(indptr_->dtype, IdType, {
+    DecodeAllRows(this, static_cast<IdType*>(indices->data),
+                  HasIdentityEdgeIds() ? nullptr : static_cast<IdType*>(edge_ids->data));
+  });
+  return CSRPtr(new CSR(indptr_, indices, edge_ids, is_multigraph_));
+}
+
+int64_t CompressedCSR::MemorySize() const {
+  return (num_rows_ + 1) * NumBits() / 8
+    + col_data_.size() + col_offsets_.size() * sizeof(uint64_t)
+    + eid_data_.size() + eid_offsets_.size() * sizeof(uint64_t);
+}
+
+}  // namespace dgl
@@ -0,0 +1,136 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file graph/compressed_csr.h
+ * \brief Compressed CSR storage for read-only graphs.
+ */
+#ifndef DGL_GRAPH_COMPRESSED_CSR_H_
+#define DGL_GRAPH_COMPRESSED_CSR_H_
+
+#include <dgl/immutable_graph.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dgl {
+
+/*!
+ * \brief CSR whose neighbor lists and edge ids are stored compressed.
+ *
+ * Each row (neighbor list or edge id list) is delta-encoded: the first value
+ * is stored as a varint relative to a base (the row id for neighbors, the
+ * position of the row for edge ids), and the remaining deltas are stored in
+ * blocks of kBlockSize values. Each block is frame-of-reference bit-packed with
+ * the smallest width that fits. Sorted rows store the plain gaps; unsorted rows
+ * store zigzag-encoded deltas. If the edge ids are 0, 1, ..., nnz - 1 in CSR
+ * order, they are not stored at all.
+ *
+ * The indptr array is kept as is so that the degree and the edge position of
+ * a row are available without decoding. The encoded rows are grouped in
+ * blocks of kRowsPerBlock rows, and only the byte offset of each block is
+ * stored in full. A block starts with the byte offsets of its rows relative to
+ * the first one, bit-packed with the smallest width that fits.
+ *
+ * Rows are decoded independently, so the structure is safe to read from
+ * multiple threads.
+ *
+ * Only CPU graphs are supported.
+ */
+class CompressedCSR {
+ public:
+  /*! \brief Number of deltas in one bit-packed block. */
+  static constexpr int64_t kBlockSize = 128;
+
+  /*! \brief Number of rows sharing one stored byte offset. */
+  static constexpr int64_t kRowsPerBlock = 64;
+
+  /*! \brief Compress the given CSR graph. */
+  explicit CompressedCSR(CSRPtr csr);
+
+  /*! \return the number of rows */
+  int64_t NumRows() const {
+    return num_rows_;
+  }
+
+  /*! \return the number of columns */
+  int64_t NumCols() const {
+    return num_cols_;
+  }
+
+  /*! \return the number of non-zero entries (i.e., edges) */
+  int64_t NumEdges() const {
+    return RowStart(num_rows_);
+  }
+
+  /*! \return the number of bits of the ids of the uncompressed graph */
+  uint8_t NumBits() const {
+    return indptr_->dtype.bits;
+  }
+
+  /*! \return whether the graph is a multigraph */
+  bool IsMultigraph() const {
+    return is_multigraph_;
+  }
+
+  /*! \return true if the edge ids are implicit (i.e., the CSR position) */
+  bool HasIdentityEdgeIds() const {
+    return eid_data_.empty();
+  }
+
+  /*! \return the position of the first entry of the row */
+  int64_t RowStart(int64_t row) const {
+    return (NumBits() == 32) ? static_cast<const int32_t*>(indptr_->data)[row]
+                             : static_cast<const int64_t*>(indptr_->data)[row];
+  }
+
+  /*! \return the number of entries of the row */
+  int64_t RowNNZ(int64_t row) const {
+    return RowStart(row + 1) - RowStart(row);
+  }
+
+  /*!
+   * \brief Decode one row.
+   * \param row The row id.
+   * \param indices Output buffer of RowNNZ(row) column ids. Skipped if null.
+   * \param edge_ids Output buffer of RowNNZ(row) edge ids. Skipped if null.
+   */
+  template <typename IdType>
+  void DecodeRow(int64_t row, IdType* indices, IdType* edge_ids) const;
+
+  /*! \return the decoded successors of the row */
+  DGLIdIters SuccVec(int64_t row) const;
+
+  /*! \return the decoded edge ids of the row */
+  DGLIdIters OutEdgeVec(int64_t row) const;
+
+  /*! \return the decoded out edges of the row */
+  EdgeArray OutEdges(int64_t row) const;
+
+  /*! \return the number of entries of the given rows */
+  DegreeArray OutDegrees(IdArray rows) const;
+
+  /*! \return the uncompressed CSR graph */
+  CSRPtr Decompress() const;
+
+  /*! \return the number of bytes used by this structure */
+  int64_t MemorySize() const;
+
+  /*! \return the indptr array */
+  IdArray indptr() const { return indptr_; }
+
+ private:
+  // indptr of the uncompressed csr
+  IdArray indptr_;
+  int64_t num_rows_ = 0, num_cols_ = 0;
+  bool is_multigraph_ = false;
+  // encoded neighbor lists and the byte offset of each block of rows in them
+  std::vector<uint8_t> col_data_;
+  std::vector<uint64_t> col_offsets_;
+  // encoded edge ids; empty if the edge ids are the identity
+  std::vector<uint8_t> eid_data_;
+  std::vector<uint64_t> eid_offsets_;
+};
+
+}  // namespace dgl
+
+#endif  // DGL_GRAPH_COMPRESSED_CSR_H_
@@ -0,0 +1,378 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file graph/edge_list.cc
+ * \brief Parallel loader of edge list files.
+ *
+ * The file is mapped, split into chunks and scanned in parallel twice: the
+ * first pass counts the out degree of every vertex in each chunk and the
+ * second pass scatters the destinations into their rows, so the out CSR is
+ * built directly without an intermediate COO. Each chunk writes its edges
+ * after those of the previous chunks, so the rows list the edges in file
+ * order and the edge ids can be the position of the edges in the file.
+ * Besides the CSR, the loader needs one degree per chunk and vertex; the
+ * number of chunks is capped so that these take no more space than the edges.
+ */
+#include <dgl/packed_func_ext.h>
+#include <dgl/immutable_graph.h>
+#include <dmlc/omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "../c_api_common.h"
+#include "../array/cpu/parallel_util.h"
+
+using namespace dgl::runtime;
+using dgl::aten::impl::kParallelGrainSize;
+using dgl::aten::impl::ThreadRange;
+using dgl::aten::impl::ExclusiveScan;
+
+namespace dgl {
+namespace {
+
+inline bool IsDelimiter(char c) {
+  return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+inline bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+/*!
+ * \brief Parse one line of a text edge list.
+ * \return 1 if an edge is parsed, 0 if the line is blank or a comment,
+ *         -1 if the line is malformed or an id does not fit in 64 bits.
+ */
+int ParseLine(const char* p, const char* end, int64_t* src, int64_t* dst) {
+  while (p < end && IsDelimiter(*p)) ++p;
+  if (p == end || *p == '#' || *p == '%') {
+    return 0;
+  }
+  int64_t ids[2];
+  for (int k = 0; k < 2; ++k) {
+    if (k > 0) {
+      if (p == end || !IsDelimiter(*p)) {
+        return -1;
+      }
+      while (p < end && IsDelimiter(*p)) ++p;
+    }
+    if (p == end || !IsDigit(*p)) {
+      return -1;
+    }
+    int64_t v = 0;
+    while (p < end && IsDigit(*p)) {
+      const int digit = *p - '0';
+      if (v > (std::numeric_limits<int64_t>::max() - digit) / 10) {
+        return -1;
+      }
+      v = v * 10 + digit;
+      ++p;
+    }
+    ids[k] = v;
+  }
+  // the remaining columns (e.g. weights) are ignored
+  if (p != end && !IsDelimiter(*p)) {
+    return -1;
+  }
+  *src = ids[0];
+  *dst = ids[1];
+  return 1;
+}
+
+/*!
+ * \brief Call fn(chunk, src, dst) on every edge of a text edge list.
+ *
+ * The file is split into num_chunks chunks of about the same size, which are
+ * processed in parallel. The edges of a chunk are visited in file order by
+ * the same thread.
+ *
+ * \return the byte offset of the first malformed line, or -1.
+ */
+template <typename Fn>
+int64_t ForEachTextEdge(const char* data, int64_t size, int num_chunks, Fn fn) {
+  int64_t error = size;
+#pragma omp parallel for reduction(min:error)
+  for (int c = 0; c < num_chunks; ++c) {
+    int64_t begin, end;
+    ThreadRange(size, c, num_chunks, &begin, &end);
+    // a chunk owns the lines that start in it
+    while (begin > 0 && begin < end && data[begin - 1] != '\n') ++begin;
+    int64_t pos = begin;
+    while (pos < end) {
+      const char* eol = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+      const int64_t line_end = eol ? eol - data : size;
+      int64_t src, dst;
+      const int ret = ParseLine(data + pos, data + line_end, &src, &dst);
+      if (ret > 0) {
+        fn(c, src, dst);
+      } else if (ret < 0) {
+        error = std::min(error, pos);
+      }
+      pos = line_end + 1;
+    }
+  }
+  return (error == size) ? -1 : error;
+}
+
+/*!
+ * \brief Call fn(chunk, src, dst) on every edge of a binary edge list.
+ *
+ * The file is a sequence of (src, dst) pairs of FileIdType. The edges are
+ * split into num_chunks chunks as in ForEachTextEdge.
+ */
+template <typename FileIdType, typename Fn>
+void ForEachBinaryEdge(const void* data, int64_t size, int num_chunks, Fn fn) {
+  CHECK_EQ(size % (2 * sizeof(FileIdType)), 0)
+    << "The size of a binary edge list must be a multiple of "
+    << 2 * sizeof(FileIdType) << " bytes.";
+  const FileIdType* ids = static_cast<const FileIdType*>(data);
+  const int64_t num_edges = size / (2 * sizeof(FileIdType));
+#pragma omp parallel for
+  for (int c = 0; c < num_chunks; ++c) {
+    int64_t begin, end;
+    ThreadRange(num_edges, c, num_chunks, &begin, &end);
+    for (int64_t i = begin; i < end; ++i) {
+      fn(c, static_cast<int64_t>(ids[2 * i]), static_cast<int64_t>(ids[2 * i + 1]));
+    }
+  }
+}
+
+/*! \brief Call fn(chunk, src, dst) on every edge of the file, if any. */
+template <typename Fn>
+void ForEachEdge(NDArray file, const std::string &format, const std::string &path,
+                 int num_chunks, Fn fn) {
+  if (!file.defined()) {
+    return;
+  }
+  const int64_t size = file->shape[0];
+  if (format == "text") {
+    const int64_t error = ForEachTextEdge(static_cast<const char*>(file->data), size,
+                                          num_chunks, fn);
+    if (error >= 0) {
+      const char* line = static_cast<const char*>(file->data) + error;
+      const char* eol = static_cast<const char*>(std::memchr(line, '\n', size - error));
+      LOG(FATAL) << "Malformed line at byte " << error << " of " << path << ": "
+                 << std::string(line, eol ? eol : line + (size - error));
+    }
+  } else if (format == "int32") {
+    ForEachBinaryEdge<int32_t>(file->data, size, num_chunks, fn);
+  } else if (format == "int64") {
+    ForEachBinaryEdge<int64_t>(file->data, size, num_chunks, fn);
+  } else {
+    LOG(FATAL) << "Unknown edge list format: " << format;
+  }
+}
+
+/*! \return an upper bound of the number of edges in the file */
+int64_t MaxNumEdges(NDArray file, const std::string &format) {
+  const int64_t size = file.defined() ? file->shape[0] : 0;
+  if (format == "int32") {
+    return size / 8;
+  } else if (format == "int64") {
+    return size / 16;
+  }
+  // the shortest text edge is "0 0\n"
+  return size / 4;
+}
+
+template <typename IdType>
+ImmutableGraphPtr LoadEdgeList(NDArray file, const std::string &path,
+                               const std::string &format, int64_t num_vertices,
+                               bool remove_self_loops, bool remove_duplicates) {
+  // per chunk counters are padded to avoid false sharing
+  const int kPad = 8;
+  const int max_threads = omp_get_max_threads();
+  const int64_t max_num_edges = MaxNumEdges(file, format);
+  const bool parallel = file.defined() && file->shape[0] >= kParallelGrainSize;
+  std::atomic<bool> negative_id(false);
+  if (num_vertices < 0) {
+    const int num_chunks = parallel ? max_threads : 1;
+    std::vector<int64_t> max_ids(num_chunks * kPad, -1);
+    ForEachEdge(file, format, path, num_chunks, [&] (int c, int64_t src, int64_t dst) {
+        int64_t* max_id = &max_ids[c * kPad];
+        *max_id = std::max(*max_id, std::max(src, dst));
+        if (src < 0 || dst < 0) {
+          negative_id.store(true, std::memory_order_relaxed);
+        }
+      });
+    CHECK(!negative_id) << "Negative vertex id in " << path;
+    num_vertices = *std::max_element(max_ids.begin(), max_ids.end()) + 1;
+  }
+  CHECK_LE(num_vertices, std::numeric_limits<IdType>::max())
+    << "Too many vertices for " << sizeof(IdType) * 8 << "-bit ids.";
+
+  // first pass: count the out degrees of each chunk
+  const int num_chunks = !parallel ? 1 :
+    static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(max_threads,
+                                                            max_num_edges / (num_vertices + 1))));
+  std::vector<IdType> chunk_degrees(num_chunks * num_vertices, 0);
+  std::vector<int64_t> chunk_edges(num_chunks * kPad, 0);
+  std::atomic<bool> out_of_range(false);
+  ForEachEdge(file, format, path, num_chunks, [&] (int c, int64_t src, int64_t dst) {
+      if (src < 0 || dst < 0 || src >= num_vertices || dst >= num_vertices) {
+        out_of_range.store(true, std::memory_order_relaxed);
+        return;
+      }
+      if (remove_self_loops && src == dst) {
+        return;
+      }
+      ++chunk_edges[c * kPad];
+      ++chunk_degrees[c * num_vertices + src];
+    });
+  CHECK(!out_of_range) << "Vertex id out of range [0, " << num_vertices << ") in " << path;
+  int64_t num_edges = 0;
+  for (int c = 0; c < num_chunks; ++c) {
+    const int64_t n = chunk_edges[c * kPad];
+    chunk_edges[c * kPad] = num_edges;
+    num_edges += n;
+  }
+  CHECK_LE(num_edges, std::numeric_limits<IdType>::max())
+    << "Too many edges for " << sizeof(IdType) * 8 << "-bit ids.";
+  // the degree of each vertex, and where each chunk starts in the row
+  const DLContext ctx{kDLCPU, 0};
+  IdArray indptr = aten::NewIdArray(num_vertices + 1, ctx, sizeof(IdType) * 8);
+  IdType* indptr_data = static_cast<IdType*>(indptr->data);
+#pragma omp parallel for if (num_vertices >= kParallelGrainSize)
+  for (int64_t v = 0; v < num_vertices; ++v) {
+    IdType degree = 0;
+    for (int c = 0; c < num_chunks; ++c) {
+      const IdType n = chunk_degrees[c * num_vertices + v];
+      chunk_degrees[c * num_vertices + v] = degree;
+      degree += n;
+    }
+    indptr_data[v] = degree;
+  }
+  indptr_data[num_vertices] = 0;
+  ExclusiveScan(indptr_data, num_vertices + 1);
+
+  // second pass: scatter the destinations and number the edges in file order
+  IdArray indices = aten::NewIdArray(num_edges, ctx, sizeof(IdType) * 8);
+  IdArray edge_ids = aten::NewIdArray(num_edges, ctx, sizeof(IdType) * 8);
+  IdType* indices_data = static_cast<IdType*>(indices->data);
+  IdType* eid_data = static_cast<IdType*>(edge_ids->data);
+  ForEachEdge(file, format, path, num_chunks, [&] (int c, int64_t src, int64_t dst) {
+      if (remove_self_loops && src == dst) {
+        return;
+      }
+      const IdType pos = indptr_data[src] + chunk_degrees[c * num_vertices + src]++;
+      indices_data[pos] = dst;
+      eid_data[pos] = chunk_edges[c * kPad]++;
+    });
+  std::vector<IdType>().swap(chunk_degrees);
+
+  // sort each row by destination; the edge ids of a row are increasing, so
+  // the duplicate edges keep the id of their first occurrence in the file.
+  // The number of unique destinations of each row is kept in row_sizes.
+  std::vector<IdType> row_sizes(remove_duplicates ? num_vertices : 0);
+  bool is_multigraph = false;
+#pragma omp parallel reduction(||:is_multigraph) if (num_edges >= kParallelGrainSize)
+  {
+    std::vector<std::pair<IdType, IdType>> row;
+#pragma omp for schedule(dynamic, 1024)
+    for (int64_t v = 0; v < num_vertices; ++v) {
+      const IdType start = indptr_data[v], end = indptr_data[v + 1];
+      if (!std::is_sorted(indices_data + start, indices_data + end)) {
+        row.clear();
+        for (IdType i = start; i < end; ++i) {
+          row.emplace_back(indices_data[i], eid_data[i]);
+        }
+        std::sort(row.begin(), row.end());
+        for (IdType i = start; i < end; ++i) {
+          indices_data[i] = row[i - start].first;
+          eid_data[i] = row[i - start].second;
+        }
+      }
+      if (remove_duplicates) {
+        IdType size = 0;
+        for (IdType i = start; i < end; ++i) {
+          if (size == 0 || indices_data[start + size - 1] != indices_data[i]) {
+            indices_data[start + size] = indices_data[i];
+            eid_data[start + size] = eid_data[i];
+            ++size;
+          }
+        }
+        row_sizes[v] = size;
+      } else {
+        is_multigraph = is_multigraph ||
+          (std::adjacent_find(indices_data + start, indices_data + end) != indices_data + end);
+      }
+    }
+  }
+
+  if (remove_duplicates) {
+    IdArray new_indptr = aten::NewIdArray(num_vertices + 1, ctx, sizeof(IdType) * 8);
+    IdType* new_indptr_data = static_cast<IdType*>(new_indptr->data);
+    std::copy(row_sizes.begin(), row_sizes.end(), new_indptr_data);
+    new_indptr_data[num_vertices] = 0;
+    const int64_t new_num_edges = ExclusiveScan(new_indptr_data, num_vertices + 1);
+    if (new_num_edges != num_edges) {
+      // copy the rows to the compacted arrays
+      IdArray new_indices = aten::NewIdArray(new_num_edges, ctx, sizeof(IdType) * 8);
+      IdArray new_edge_ids = aten::NewIdArray(new_num_edges, ctx, sizeof(IdType) * 8);
+      IdType* new_indices_data = static_cast<IdType*>(new_indices->data);
+      IdType* new_eid_data = static_cast<IdType*>(new_edge_ids->data);
+#pragma omp parallel for schedule(dynamic, 1024) if (num_edges >= kParallelGrainSize)
+      for (int64_t v = 0; v < num_vertices; ++v) {
+        std::copy(indices_data + indptr_data[v], indices_data + indptr_data[v] + row_sizes[v],
+                  new_indices_data + new_indptr_data[v]);
+        std::copy(eid_data + indptr_data[v], eid_data + indptr_data[v] + row_sizes[v],
+                  new_eid_data + new_indptr_data[v]);
+      }
+      // renumber the remaining edges in file order
+      std::vector<IdType> new_ids(num_edges, 0);
+#pragma omp parallel for if (new_num_edges >= kParallelGrainSize)
+      for (int64_t i = 0; i < new_num_edges; ++i) {
+        new_ids[new_eid_data[i]] = 1;
+      }
+      ExclusiveScan(new_ids.data(), num_edges);
+#pragma omp parallel for if (new_num_edges >= kParallelGrainSize)
+      for (int64_t i = 0; i < new_num_edges; ++i) {
+        new_eid_data[i] = new_ids[new_eid_data[i]];
+      }
+      indptr = new_indptr;
+      indices = new_indices;
+      edge_ids = new_edge_ids;
+    }
+  }
+  return ImmutableGraph::CreateFromCSR(indptr, indices, edge_ids, is_multigraph, "out");
+}
+
+}  // namespace
+
+ImmutableGraphPtr ImmutableGraph::LoadEdgeList(
+    const std::string &path, const std::string &format, int64_t num_vertices,
+    bool remove_self_loops, bool remove_duplicates, uint8_t bits) {
+  // an empty file has no edges; it cannot be mapped
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  CHECK(in) << "Failed to open " << path;
+  NDArray file = (in.tellg() > 0) ? NDArray::MapFile(path) : NDArray();
+  in.close();
+  if (bits == 32) {
+    return dgl::LoadEdgeList<int32_t>(file, path, format, num_vertices,
+                                      remove_self_loops, remove_duplicates);
+  } else if (bits == 64) {
+    return dgl::LoadEdgeList<int64_t>(file, path, format, num_vertices,
+                                      remove_self_loops, remove_duplicates);
+  }
+  LOG(FATAL) << "Invalid number of bits: " << static_cast<int>(bits);
+  return nullptr;
+}
+
+DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphLoadEdgeList")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const std::string path = args[0];
+    const std::string format = args[1];
+    const int64_t num_vertices = args[2];
+    const bool remove_self_loops = args[3];
+    const bool remove_duplicates = args[4];
+    const int bits = args[5];
+    *rv = GraphRef(ImmutableGraph::LoadEdgeList(path, format, num_vertices,
+                                                remove_self_loops, remove_duplicates, bits));
+  });
+
+}  // namespace dgl
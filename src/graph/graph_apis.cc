@@ -76,11 +76,8 @@ DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLGraphCSRCreate")
     const int multigraph = args[3];
     const std::string edge_dir = args[4];
 
-    IdArray edge_ids = IdArray::Empty({indices->shape[0]},
-                                      DLDataType{kDLInt, 64, 1}, DLContext{kDLCPU, 0});
-    int64_t *edge_data = static_cast<int64_t *>(edge_ids->data);
-    for (size_t i = 0; i < edge_ids->shape[0]; i++)
-      edge_data[i] = i;
+    // the edge ids follow the CSR order and are not materialized
+    const IdArray edge_ids;
     if (shared_mem_name.empty()) {
       if (multigraph == kBoolUnknown) {
         *rv = GraphRef(ImmutableGraph::CreateFromCSR(indptr, indices, edge_ids, edge_dir));
@@ -0,0 +1,290 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file graph/graph_file.cc
+ * \brief Binary file format of immutable graphs.
+ *
+ * A graph file stores the in CSR and/or the out CSR of an immutable graph.
+ * It starts with a GraphFileHeader padded to kGraphFileAlignment bytes,
+ * followed by the indptr, indices and edge id arrays of each CSR. Every array
+ * starts at a multiple of kGraphFileAlignment, so that the file can be mapped
+ * and the arrays used in place. The arrays are stored in the native byte
+ * order with the number of bits of the graph.
+ */
+#include <dgl/packed_func_ext.h>
+#include <dgl/immutable_graph.h>
+#include <dmlc/omp.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "../c_api_common.h"
+#include "../array/cpu/parallel_util.h"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace {
+
+// "DGLGRAPH" in little endian
+constexpr uint64_t kGraphFileMagic = 0x48504152474c4744ULL;
+constexpr uint32_t kGraphFileVersion = 1;
+constexpr int64_t kGraphFileAlignment = 4096;
+
+// The sections of a CSR in the file.
+enum GraphFileSection {
+  kIndptr = 0,
+  kIndices,
+  kEdgeIds,
+  kNumSections
+};
+
+struct GraphFileHeader {
+  uint64_t magic;
+  uint32_t version;
+  // number of bits of the ids (32 or 64)
+  uint32_t num_bits;
+  int64_t num_vertices;
+  int64_t num_edges;
+  uint32_t is_multigraph;
+  uint32_t reserved;
+  // size of the whole file in bytes
+  int64_t file_size;
+  // checksum of everything after the header page
+  uint64_t checksum;
+  // byte offset of each section of the in csr ([0]) and the out csr ([1]).
+  // A missing csr has zero offsets. A csr with zero edge id offset has
+  // implicit edge ids.
+  int64_t offsets[2][kNumSections];
+};
+
+static_assert(sizeof(GraphFileHeader) <= kGraphFileAlignment,
+              "The graph file header must fit in a page");
+
+inline int64_t AlignUp(int64_t size) {
+  return (size + kGraphFileAlignment - 1) / kGraphFileAlignment * kGraphFileAlignment;
+}
+
+// The finalizer of splitmix64. Zero is mapped to zero.
+inline uint64_t Mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/*!
+ * \brief Checksum of a byte range seen as 8-byte words.
+ *
+ * The i-th word of the file payload contributes Mix(word) * (2 * i + 1), so
+ * zero padding does not change the checksum and the sections can be summed
+ * up separately. The last partial word is padded with zeros.
+ *
+ * \param data The bytes.
+ * \param size The number of bytes.
+ * \param first_word The index of the first word in the payload.
+ */
+uint64_t Checksum(const uint8_t* data, int64_t size, int64_t first_word) {
+  const int64_t num_words = size / 8;
+  uint64_t sum = 0;
+#pragma omp parallel for reduction(+:sum) if (num_words >= aten::impl::kParallelGrainSize)
+  for (int64_t i = 0; i < num_words; ++i) {
+    uint64_t word;
+    std::memcpy(&word, data + i * 8, 8);
+    sum += Mix(word) * (2 * (first_word + i) + 1);
+  }
+  if (size % 8 != 0) {
+    uint64_t word = 0;
+    std::memcpy(&word, data + num_words * 8, size % 8);
+    sum += Mix(word) * (2 * (first_word + num_words) + 1);
+  }
+  return sum;
+}
+
+int64_t ArrayBytes(IdArray arr) {
+  return arr->shape[0] * arr->dtype.bits / 8;
+}
+
+// Return whether indptr starts at zero, ends at num_edges and never decreases.
+template <typename IdType>
+bool IsValidIndptr(IdArray indptr, int64_t num_edges) {
+  const IdType* data = static_cast<IdType*>(indptr->data);
+  const int64_t len = indptr->shape[0];
+  if (data[0] != 0 || data[len - 1] != num_edges) {
+    return false;
+  }
+  int64_t num_invalid = 0;
+#pragma omp parallel for reduction(+:num_invalid) \
+    if (len >= aten::impl::kParallelGrainSize)
+  for (int64_t i = 1; i < len; ++i) {
+    num_invalid += data[i] < data[i - 1];
+  }
+  return num_invalid == 0;
+}
+
+// Return whether every id of the array is in [0, bound).
+template <typename IdType>
+bool IsInRange(IdArray ids, int64_t bound) {
+  const IdType* data = static_cast<IdType*>(ids->data);
+  const int64_t len = ids->shape[0];
+  int64_t num_invalid = 0;
+#pragma omp parallel for reduction(+:num_invalid) \
+    if (len >= aten::impl::kParallelGrainSize)
+  for (int64_t i = 0; i < len; ++i) {
+    num_invalid += data[i] < 0 || data[i] >= bound;
+  }
+  return num_invalid == 0;
+}
+
+}  // namespace
+
+void ImmutableGraph::Save(const std::string &path) const {
+  CHECK_EQ(Context().device_type, kDLCPU) << "Only CPU graphs can be saved.";
+  CSRPtr csrs[2] = {CurrentInCSR(), CurrentOutCSR()};
+  if (!csrs[0] && !csrs[1]) {
+    if (compressed_in_csr_ && !compressed_out_csr_) {
+      csrs[0] = GetInCSR();
+    } else {
+      csrs[1] = GetOutCSR();
+    }
+  }
+
+  GraphFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = kGraphFileMagic;
+  header.version = kGraphFileVersion;
+  header.num_bits = NumBits();
+  header.num_vertices = NumVertices();
+  header.num_edges = NumEdges();
+  header.is_multigraph = IsMultigraph();
+  // lay out the sections
+  std::vector<IdArray> arrays;
+  std::vector<int64_t> offsets;
+  int64_t pos = kGraphFileAlignment;
+  for (int k = 0; k < 2; ++k) {
+    if (!csrs[k]) {
+      continue;
+    }
+    const IdArray sections[kNumSections] = {
+      csrs[k]->indptr(), csrs[k]->indices(), csrs[k]->edge_ids()};
+    for (int s = 0; s < kNumSections; ++s) {
+      if (!sections[s].defined()) {
+        continue;
+      }
+      header.offsets[k][s] = pos;
+      arrays.push_back(sections[s]);
+      offsets.push_back(pos);
+      pos = AlignUp(pos + ArrayBytes(sections[s]));
+    }
+  }
+  header.file_size = pos;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    header.checksum += Checksum(static_cast<const uint8_t*>(arrays[i]->data),
+                                ArrayBytes(arrays[i]),
+                                (offsets[i] - kGraphFileAlignment) / 8);
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  CHECK(out) << "Failed to open " << path << " for writing.";
+  std::vector<char> page(kGraphFileAlignment, 0);
+  std::memcpy(page.data(), &header, sizeof(header));
+  out.write(page.data(), kGraphFileAlignment);
+  // the page is reused as the zero padding of the sections
+  std::fill(page.begin(), page.end(), 0);
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const int64_t nbytes = ArrayBytes(arrays[i]);
+    const int64_t end = (i + 1 < arrays.size()) ? offsets[i + 1] : header.file_size;
+    out.write(static_cast<const char*>(arrays[i]->data), nbytes);
+    out.write(page.data(), end - offsets[i] - nbytes);
+  }
+  CHECK(out) << "Failed to write " << path;
+}
+
+ImmutableGraphPtr ImmutableGraph::Load(const std::string &path, bool verify_checksum) {
+  NDArray file = NDArray::MapFile(path);
+  const int64_t file_size = file->shape[0];
+  const uint8_t* data = static_cast<const uint8_t*>(file->data);
+  CHECK_GE(file_size, kGraphFileAlignment) << path << " is not a graph file.";
+  GraphFileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  CHECK_EQ(header.magic, kGraphFileMagic) << path << " is not a graph file.";
+  CHECK_EQ(header.version, kGraphFileVersion)
+    << "Unsupported graph file version " << header.version << " in " << path;
+  CHECK_EQ(header.file_size, file_size) << "Truncated graph file: " << path;
+  CHECK(header.num_bits == 32 || header.num_bits == 64)
+    << "Invalid number of bits " << header.num_bits << " in " << path;
+  if (verify_checksum) {
+    const uint64_t checksum = Checksum(data + kGraphFileAlignment,
+                                       file_size - kGraphFileAlignment, 0);
+    CHECK_EQ(checksum, header.checksum) << "Checksum mismatch in graph file: " << path;
+  }
+
+  CHECK(header.num_vertices >= 0 && header.num_edges >= 0)
+    << "Invalid graph size in " << path;
+
+  const DLDataType dtype{kDLInt, static_cast<uint8_t>(header.num_bits), 1};
+  const int64_t lengths[kNumSections] = {
+    header.num_vertices + 1, header.num_edges, header.num_edges};
+  CSRPtr csrs[2];
+  for (int k = 0; k < 2; ++k) {
+    if (header.offsets[k][kIndptr] == 0) {
+      continue;
+    }
+    IdArray sections[kNumSections];
+    for (int s = 0; s < kNumSections; ++s) {
+      const int64_t offset = header.offsets[k][s];
+      if (offset == 0) {
+        continue;
+      }
+      CHECK(offset % kGraphFileAlignment == 0
+            && offset + lengths[s] * header.num_bits / 8 <= file_size)
+        << "Invalid section offset " << offset << " in " << path;
+      sections[s] = file.CreateView({lengths[s]}, dtype, offset);
+    }
+    CHECK(sections[kIndices].defined()) << "Missing indices in " << path;
+    // the indptr bounds every access to the other arrays, so it is validated
+    // even if the checksum is not
+    const bool valid = header.num_bits == 32
+      ? IsValidIndptr<int32_t>(sections[kIndptr], header.num_edges)
+      : IsValidIndptr<int64_t>(sections[kIndptr], header.num_edges);
+    CHECK(valid) << "Invalid indptr in " << path;
+    // without the checksum, the ids are checked so that a corrupted file
+    // cannot lead to out-of-bounds accesses
+    if (!verify_checksum) {
+      const int64_t bounds[kNumSections] = {0, header.num_vertices, header.num_edges};
+      for (int s = kIndices; s < kNumSections; ++s) {
+        if (sections[s].defined()) {
+          const bool in_range = header.num_bits == 32
+            ? IsInRange<int32_t>(sections[s], bounds[s])
+            : IsInRange<int64_t>(sections[s], bounds[s]);
+          CHECK(in_range) << "Invalid " << (s == kIndices ? "indices" : "edge ids")
+                          << " in " << path;
+        }
+      }
+    }
+    csrs[k] = CSRPtr(new CSR(sections[kIndptr], sections[kIndices], sections[kEdgeIds],
+                             header.is_multigraph != 0));
+    // the mapping is read-only
+    csrs[k]->mapped_ = true;
+  }
+  CHECK(csrs[0] || csrs[1]) << "No graph structure in " << path;
+  return ImmutableGraphPtr(new ImmutableGraph(csrs[0], csrs[1]));
+}
+
+DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphSave")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GraphRef g = args[0];
+    const std::string path = args[1];
+    ImmutableGraphPtr ig = std::dynamic_pointer_cast<ImmutableGraph>(g.sptr());
+    CHECK(ig) << "Only immutable graphs can be saved.";
+    ig->Save(path);
+  });
+
+DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphLoad")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const std::string path = args[0];
+    const bool verify_checksum = args[1];
+    *rv = GraphRef(ImmutableGraph::Load(path, verify_checksum));
+  });
+
+}  // namespace dgl
@@ -119,7 +119,9 @@ GraphPtr GraphOp::DisjointUnion(std::vector<GraphPtr> graphs) {
       const int64_t g_num_edges = g_csrptr->NumEdges();
       dgl_id_t* g_indptr = static_cast<dgl_id_t*>(g_csrptr->indptr()->data);
       dgl_id_t* g_indices = static_cast<dgl_id_t*>(g_csrptr->indices()->data);
-      dgl_id_t* g_edge_ids = static_cast<dgl_id_t*>(g_csrptr->edge_ids()->data);
+      // null if the edge ids are implicit
+      const dgl_id_t* g_edge_ids = g_csrptr->edge_ids().defined() ?
+        static_cast<dgl_id_t*>(g_csrptr->edge_ids()->data) : nullptr;
       for (dgl_id_t i = 1; i < g_num_nodes + 1; ++i) {
         indptr[cum_num_nodes + i] = g_indptr[i] + cum_num_edges;
       }
@@ -128,7 +130,7 @@ GraphPtr GraphOp::DisjointUnion(std::vector<GraphPtr> graphs) {
       }
 
       for (dgl_id_t i = 0; i < g_num_edges; ++i) {
-        edge_ids[cum_num_edges + i] = g_edge_ids[i] + cum_num_edges;
+        edge_ids[cum_num_edges + i] = (g_edge_ids ? g_edge_ids[i] : i) + cum_num_edges;
       }
       cum_num_nodes += g_num_nodes;
       cum_num_edges += g_num_edges;
@@ -212,7 +214,9 @@ std::vector<GraphPtr> GraphOp::DisjointPartitionBySizes(
     CSRPtr in_csr_ptr = graph->GetInCSR();
     const dgl_id_t* indptr = static_cast<dgl_id_t*>(in_csr_ptr->indptr()->data);
     const dgl_id_t* indices = static_cast<dgl_id_t*>(in_csr_ptr->indices()->data);
-    const dgl_id_t* edge_ids = static_cast<dgl_id_t*>(in_csr_ptr->edge_ids()->data);
+    // null if the edge ids are implicit, in which case they stay implicit in the partitions
+    const dgl_id_t* edge_ids = in_csr_ptr->edge_ids().defined() ?
+      static_cast<dgl_id_t*>(in_csr_ptr->edge_ids()->data) : nullptr;
     dgl_id_t cum_sum_edges = 0;
     for (int64_t i = 0; i < len; ++i) {
       const int64_t start_pos = cumsum[i];
@@ -221,10 +225,9 @@ std::vector<GraphPtr> GraphOp::DisjointPartitionBySizes(
       const int64_t g_num_edges = indptr[end_pos] - indptr[start_pos];
       IdArray indptr_arr = aten::NewIdArray(g_num_nodes + 1);
       IdArray indices_arr = aten::NewIdArray(g_num_edges);
-      IdArray edge_ids_arr = aten::NewIdArray(g_num_edges);
+      IdArray edge_ids_arr = edge_ids ? aten::NewIdArray(g_num_edges) : IdArray();
       dgl_id_t* g_indptr = static_cast<dgl_id_t*>(indptr_arr->data);
       dgl_id_t* g_indices = static_cast<dgl_id_t*>(indices_arr->data);
-      dgl_id_t* g_edge_ids = static_cast<dgl_id_t*>(edge_ids_arr->data);
 
       const dgl_id_t idoff = indptr[start_pos];
       g_indptr[0] = 0;
@@ -236,8 +239,11 @@ std::vector<GraphPtr> GraphOp::DisjointPartitionBySizes(
         g_indices[j - idoff] = indices[j] - cumsum[i];
       }
 
-      for (int k = indptr[start_pos]; k < indptr[end_pos]; ++k) {
-        g_edge_ids[k - idoff] = edge_ids[k] - cum_sum_edges;
+      if (edge_ids) {
+        dgl_id_t* g_edge_ids = static_cast<dgl_id_t*>(edge_ids_arr->data);
+        for (int k = indptr[start_pos]; k < indptr[end_pos]; ++k) {
+          g_edge_ids[k - idoff] = edge_ids[k] - cum_sum_edges;
+        }
       }
 
       cum_sum_edges += g_num_edges;
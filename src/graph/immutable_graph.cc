@@ -12,6 +12,7 @@
 #include <tuple>
 
 #include "../c_api_common.h"
+#include "./compressed_csr.h"
 
 using namespace dgl::runtime;
 
@@ -41,6 +42,17 @@ std::tuple<IdArray, IdArray, IdArray> MapFromSharedMemory(
   return {};
 #endif  // _WIN32
 }
+
+// The shared memory layout always has room for the edge ids, so implicit
+// edge ids are written out there.
+void CopyEdgeIdsToSharedMem(IdArray edge_ids, IdArray* sm_edge_ids) {
+  if (edge_ids.defined()) {
+    sm_edge_ids->CopyFrom(edge_ids);
+  } else {
+    dgl_id_t* sm_data = static_cast<dgl_id_t*>((*sm_edge_ids)->data);
+    std::iota(sm_data, sm_data + (*sm_edge_ids)->shape[0], 0);
+  }
+}
 }  // namespace
 
 //////////////////////////////////////////////////////////
@@ -61,8 +73,8 @@ CSR::CSR(int64_t num_vertices, int64_t num_edges, bool is_multigraph)
 CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids) {
   CHECK(IsValidIdArray(indptr));
   CHECK(IsValidIdArray(indices));
-  CHECK(IsValidIdArray(edge_ids));
-  CHECK_EQ(indices->shape[0], edge_ids->shape[0]);
+  CHECK(!edge_ids.defined() || IsValidIdArray(edge_ids));
+  CHECK(!edge_ids.defined() || indices->shape[0] == edge_ids->shape[0]);
   const int64_t N = indptr->shape[0] - 1;
   adj_ = aten::CSRMatrix{N, N, indptr, indices, edge_ids};
 }
@@ -71,8 +83,8 @@ CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids, bool is_multigraph)
   : is_multigraph_(is_multigraph) {
   CHECK(IsValidIdArray(indptr));
   CHECK(IsValidIdArray(indices));
-  CHECK(IsValidIdArray(edge_ids));
-  CHECK_EQ(indices->shape[0], edge_ids->shape[0]);
+  CHECK(!edge_ids.defined() || IsValidIdArray(edge_ids));
+  CHECK(!edge_ids.defined() || indices->shape[0] == edge_ids->shape[0]);
   const int64_t N = indptr->shape[0] - 1;
   adj_ = aten::CSRMatrix{N, N, indptr, indices, edge_ids};
 }
@@ -81,8 +93,8 @@ CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids,
          const std::string &shared_mem_name): shared_mem_name_(shared_mem_name) {
   CHECK(IsValidIdArray(indptr));
   CHECK(IsValidIdArray(indices));
-  CHECK(IsValidIdArray(edge_ids));
-  CHECK_EQ(indices->shape[0], edge_ids->shape[0]);
+  CHECK(!edge_ids.defined() || IsValidIdArray(edge_ids));
+  CHECK(!edge_ids.defined() || indices->shape[0] == edge_ids->shape[0]);
   const int64_t num_verts = indptr->shape[0] - 1;
   const int64_t num_edges = indices->shape[0];
   adj_.num_rows = num_verts;
@@ -92,7 +104,7 @@ CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids,
   // copy the given data into the shared memory arrays
   adj_.indptr.CopyFrom(indptr);
   adj_.indices.CopyFrom(indices);
-  adj_.data.CopyFrom(edge_ids);
+  CopyEdgeIdsToSharedMem(edge_ids, &adj_.data);
 }
 
 CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids, bool is_multigraph,
@@ -100,8 +112,8 @@ CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids, bool is_multigraph,
          shared_mem_name_(shared_mem_name) {
   CHECK(IsValidIdArray(indptr));
   CHECK(IsValidIdArray(indices));
-  CHECK(IsValidIdArray(edge_ids));
-  CHECK_EQ(indices->shape[0], edge_ids->shape[0]);
+  CHECK(!edge_ids.defined() || IsValidIdArray(edge_ids));
+  CHECK(!edge_ids.defined() || indices->shape[0] == edge_ids->shape[0]);
   const int64_t num_verts = indptr->shape[0] - 1;
   const int64_t num_edges = indices->shape[0];
   adj_.num_rows = num_verts;
@@ -111,7 +123,7 @@ CSR::CSR(IdArray indptr, IdArray indices, IdArray edge_ids, bool is_multigraph,
   // copy the given data into the shared memory arrays
   adj_.indptr.CopyFrom(indptr);
   adj_.indices.CopyFrom(indices);
-  adj_.data.CopyFrom(edge_ids);
+  CopyEdgeIdsToSharedMem(edge_ids, &adj_.data);
 }
 
 CSR::CSR(const std::string &shared_mem_name,
@@ -131,6 +143,12 @@ bool CSR::IsMultigraph() const {
     });
 }
 
+bool CSR::IsSorted() const {
+  return const_cast<CSR*>(this)->is_sorted_.Get([this] () {
+      return aten::CSRIsSorted(adj_);
+    });
+}
+
 EdgeArray CSR::OutEdges(dgl_id_t vid) const {
   CHECK(HasVertex(vid)) << "invalid vertex: " << vid;
   IdArray ret_dst = aten::CSRGetRowColumnIndices(adj_, vid);
@@ -163,7 +181,10 @@ bool CSR::HasEdgeBetween(dgl_id_t src, dgl_id_t dst) const {
 BoolArray CSR::HasEdgesBetween(IdArray src_ids, IdArray dst_ids) const {
   CHECK(IsValidIdArray(src_ids)) << "Invalid vertex id array.";
   CHECK(IsValidIdArray(dst_ids)) << "Invalid vertex id array.";
-  return aten::CSRIsNonZero(adj_, src_ids, dst_ids);
+  // batched lookups binary search the rows if they are sorted
+  aten::CSRMatrix adj = adj_;
+  adj.sorted = IsSorted();
+  return aten::CSRIsNonZero(adj, src_ids, dst_ids);
 }
 
 IdArray CSR::Successors(dgl_id_t vid, uint64_t radius) const {
@@ -179,7 +200,9 @@ IdArray CSR::EdgeId(dgl_id_t src, dgl_id_t dst) const {
 }
 
 EdgeArray CSR::EdgeIds(IdArray src_ids, IdArray dst_ids) const {
-  const auto& arrs = aten::CSRGetDataAndIndices(adj_, src_ids, dst_ids);
+  aten::CSRMatrix adj = adj_;
+  adj.sorted = IsSorted();
+  const auto& arrs = aten::CSRGetDataAndIndices(adj, src_ids, dst_ids);
   return EdgeArray{arrs[0], arrs[1], arrs[2]};
 }
 
@@ -188,20 +211,24 @@ EdgeArray CSR::Edges(const std::string &order) const {
     << "CSR only support Edges of order \"srcdst\","
     << " but got \"" << order << "\".";
   const auto& coo = aten::CSRToCOO(adj_, false);
-  return EdgeArray{coo.row, coo.col, coo.data};
+  IdArray eids = aten::COOHasData(coo) ? coo.data
+    : aten::Range(0, NumEdges(), NumBits(), Context());
+  return EdgeArray{coo.row, coo.col, eids};
 }
 
 Subgraph CSR::VertexSubgraph(IdArray vids) const {
   CHECK(IsValidIdArray(vids)) << "Invalid vertex id array.";
   const auto& submat = aten::CSRSliceMatrix(adj_, vids, vids);
-  IdArray sub_eids = aten::Range(0, submat.data->shape[0], NumBits(), Context());
-  CSRPtr subcsr(new CSR(submat.indptr, submat.indices, sub_eids));
+  // the edges of the subgraph are numbered in CSR order
+  CSRPtr subcsr(new CSR(submat.indptr, submat.indices, IdArray()));
   return Subgraph{subcsr, vids, submat.data};
 }
 
 CSRPtr CSR::Transpose() const {
   const auto& trans = aten::CSRTranspose(adj_);
-  return CSRPtr(new CSR(trans.indptr, trans.indices, trans.data));
+  CSRPtr ret(new CSR(trans.indptr, trans.indices, trans.data));
+  ret->adj_.sorted = trans.sorted;
+  return ret;
 }
 
 COOPtr CSR::ToCOO() const {
@@ -215,8 +242,9 @@ CSR CSR::CopyTo(const DLContext& ctx) const {
   } else {
     CSR ret(adj_.indptr.CopyTo(ctx),
             adj_.indices.CopyTo(ctx),
-            adj_.data.CopyTo(ctx));
+            aten::CSRHasData(adj_) ? adj_.data.CopyTo(ctx) : IdArray());
     ret.is_multigraph_ = is_multigraph_;
+    ret.is_sorted_ = is_sorted_;
     return ret;
   }
 }
@@ -236,8 +264,9 @@ CSR CSR::AsNumBits(uint8_t bits) const {
   } else {
     CSR ret(aten::AsNumBits(adj_.indptr, bits),
             aten::AsNumBits(adj_.indices, bits),
-            aten::AsNumBits(adj_.data, bits));
+            aten::CSRHasData(adj_) ? aten::AsNumBits(adj_.data, bits) : IdArray());
     ret.is_multigraph_ = is_multigraph_;
+    ret.is_sorted_ = is_sorted_;
     return ret;
   }
 }
@@ -256,9 +285,14 @@ DGLIdIters CSR::OutEdgeVec(dgl_id_t vid) const {
   // TODO(minjie): This still assumes the data type and device context
   //   of this graph. Should fix later.
   const dgl_id_t* indptr_data = static_cast<dgl_id_t*>(adj_.indptr->data);
-  const dgl_id_t* eid_data = static_cast<dgl_id_t*>(adj_.data->data);
   const dgl_id_t start = indptr_data[vid];
   const dgl_id_t end = indptr_data[vid + 1];
+  if (!aten::CSRHasData(adj_)) {
+    auto eids = std::make_shared<std::vector<dgl_id_t>>(end - start);
+    std::iota(eids->begin(), eids->end(), start);
+    return DGLIdIters(eids);
+  }
+  const dgl_id_t* eid_data = static_cast<dgl_id_t*>(adj_.data->data);
   return DGLIdIters(eid_data + start, eid_data + end);
 }
 
@@ -369,61 +403,309 @@ COO COO::AsNumBits(uint8_t bits) const {
 //
 //////////////////////////////////////////////////////////
 
+DLContext ImmutableGraph::Context() const {
+  if (!CurrentInCSR() && !CurrentOutCSR() && !CurrentCOO()) {
+    // compressed graphs are always on CPU
+    return DLContext{kDLCPU, 0};
+  }
+  return AnyGraph()->Context();
+}
+
+uint8_t ImmutableGraph::NumBits() const {
+  if (const CompressedCSRPtr csr = AnyCompressedCSR()) {
+    return csr->NumBits();
+  }
+  return AnyGraph()->NumBits();
+}
+
+bool ImmutableGraph::IsMultigraph() const {
+  if (const CompressedCSRPtr csr = AnyCompressedCSR()) {
+    return csr->IsMultigraph();
+  }
+  return AnyGraph()->IsMultigraph();
+}
+
+uint64_t ImmutableGraph::NumVertices() const {
+  if (const CompressedCSRPtr csr = AnyCompressedCSR()) {
+    return csr->NumRows();
+  }
+  return AnyGraph()->NumVertices();
+}
+
+uint64_t ImmutableGraph::NumEdges() const {
+  if (const CompressedCSRPtr csr = AnyCompressedCSR()) {
+    return csr->NumEdges();
+  }
+  return AnyGraph()->NumEdges();
+}
+
 BoolArray ImmutableGraph::HasVertices(IdArray vids) const {
   CHECK(IsValidIdArray(vids)) << "Invalid id array input";
   return aten::LT(vids, NumVertices());
 }
 
+uint64_t ImmutableGraph::InDegree(dgl_id_t vid) const {
+  if (compressed_in_csr_) {
+    return compressed_in_csr_->RowNNZ(vid);
+  }
+  return GetInCSR()->OutDegree(vid);
+}
+
+uint64_t ImmutableGraph::OutDegree(dgl_id_t vid) const {
+  if (compressed_out_csr_) {
+    return compressed_out_csr_->RowNNZ(vid);
+  }
+  return GetOutCSR()->OutDegree(vid);
+}
+
+// The per-vertex queries prefer the uncompressed CSR if it has been built,
+//   which saves the decoding.
+
+DGLIdIters ImmutableGraph::SuccVec(dgl_id_t vid) const {
+  if (compressed_out_csr_ && !CurrentOutCSR()) {
+    return compressed_out_csr_->SuccVec(vid);
+  }
+  return GetOutCSR()->SuccVec(vid);
+}
+
+DGLIdIters ImmutableGraph::OutEdgeVec(dgl_id_t vid) const {
+  if (compressed_out_csr_ && !CurrentOutCSR()) {
+    return compressed_out_csr_->OutEdgeVec(vid);
+  }
+  return GetOutCSR()->OutEdgeVec(vid);
+}
+
+DGLIdIters ImmutableGraph::PredVec(dgl_id_t vid) const {
+  if (compressed_in_csr_ && !CurrentInCSR()) {
+    return compressed_in_csr_->SuccVec(vid);
+  }
+  return GetInCSR()->SuccVec(vid);
+}
+
+DGLIdIters ImmutableGraph::InEdgeVec(dgl_id_t vid) const {
+  if (compressed_in_csr_ && !CurrentInCSR()) {
+    return compressed_in_csr_->OutEdgeVec(vid);
+  }
+  return GetInCSR()->OutEdgeVec(vid);
+}
+
+bool ImmutableGraph::HasEdgeBetween(dgl_id_t src, dgl_id_t dst) const {
+  if (const CSRPtr in_csr = CurrentInCSR()) {
+    return in_csr->HasEdgeBetween(dst, src);
+  } else if (compressed_out_csr_ && !CurrentOutCSR()) {
+    CHECK(HasVertex(dst)) << "Invalid vertex id: " << dst;
+    const DGLIdIters succ = SuccVec(src);
+    return std::find(succ.begin(), succ.end(), dst) != succ.end();
+  }
+  return GetOutCSR()->HasEdgeBetween(src, dst);
+}
+
+IdArray ImmutableGraph::Predecessors(dgl_id_t vid, uint64_t radius) const {
+  if (compressed_in_csr_ && !CurrentInCSR()) {
+    CHECK(radius == 1) << "invalid radius: " << radius;
+    return compressed_in_csr_->OutEdges(vid).dst;
+  }
+  return GetInCSR()->Successors(vid, radius);
+}
+
+IdArray ImmutableGraph::Successors(dgl_id_t vid, uint64_t radius) const {
+  if (compressed_out_csr_ && !CurrentOutCSR()) {
+    CHECK(radius == 1) << "invalid radius: " << radius;
+    return compressed_out_csr_->OutEdges(vid).dst;
+  }
+  return GetOutCSR()->Successors(vid, radius);
+}
+
+IdArray ImmutableGraph::EdgeId(dgl_id_t src, dgl_id_t dst) const {
+  if (const CSRPtr in_csr = CurrentInCSR()) {
+    return in_csr->EdgeId(dst, src);
+  } else if (compressed_out_csr_ && !CurrentOutCSR()) {
+    CHECK(HasVertex(dst)) << "invalid vertex: " << dst;
+    const DGLIdIters succ = SuccVec(src);
+    const DGLIdIters eids = OutEdgeVec(src);
+    std::vector<dgl_id_t> ret;
+    for (size_t i = 0; i < succ.size(); ++i) {
+      if (succ[i] == dst) {
+        ret.push_back(eids[i]);
+      }
+    }
+    return aten::VecToIdArray(ret, NumBits());
+  }
+  return GetOutCSR()->EdgeId(src, dst);
+}
+
+EdgeArray ImmutableGraph::InEdges(dgl_id_t vid) const {
+  const EdgeArray& ret = (compressed_in_csr_ && !CurrentInCSR()) ?
+    compressed_in_csr_->OutEdges(vid) : GetInCSR()->OutEdges(vid);
+  return {ret.dst, ret.src, ret.id};
+}
+
+EdgeArray ImmutableGraph::OutEdges(dgl_id_t vid) const {
+  if (compressed_out_csr_ && !CurrentOutCSR()) {
+    return compressed_out_csr_->OutEdges(vid);
+  }
+  return GetOutCSR()->OutEdges(vid);
+}
+
+DegreeArray ImmutableGraph::InDegrees(IdArray vids) const {
+  if (compressed_in_csr_ && !CurrentInCSR()) {
+    CHECK(IsValidIdArray(vids)) << "Invalid vertex id array.";
+    return compressed_in_csr_->OutDegrees(vids);
+  }
+  return GetInCSR()->OutDegrees(vids);
+}
+
+DegreeArray ImmutableGraph::OutDegrees(IdArray vids) const {
+  if (compressed_out_csr_ && !CurrentOutCSR()) {
+    CHECK(IsValidIdArray(vids)) << "Invalid vertex id array.";
+    return compressed_out_csr_->OutDegrees(vids);
+  }
+  return GetOutCSR()->OutDegrees(vids);
+}
+
 CSRPtr ImmutableGraph::GetInCSR() const {
-  if (!in_csr_) {
-    if (out_csr_) {
-      const_cast<ImmutableGraph*>(this)->in_csr_ = out_csr_->Transpose();
-      if (out_csr_->IsSharedMem())
+  CSRPtr in_csr = CurrentInCSR();
+  if (in_csr) {
+    return in_csr;
+  }
+  if (compressed_in_csr_) {
+    // not cached, which would defeat the compression; see Materialize
+    return compressed_in_csr_->Decompress();
+  }
+  std::lock_guard<std::mutex> lock(in_csr_mutex_);
+  // Another thread may have built it while we were waiting.
+  in_csr = CurrentInCSR();
+  if (!in_csr) {
+    const CSRPtr out_csr = CurrentOutCSR();
+    const COOPtr coo = CurrentCOO();
+    if (out_csr) {
+      in_csr = out_csr->Transpose();
+      if (out_csr->IsSharedMem())
         LOG(WARNING) << "We just construct an in-CSR from a shared-memory out CSR. "
                      << "It may dramatically increase memory consumption.";
     } else {
-      CHECK(coo_) << "None of CSR, COO exist";
-      const_cast<ImmutableGraph*>(this)->in_csr_ = coo_->Transpose()->ToCSR();
+      CHECK(coo) << "None of CSR, COO exist";
+      in_csr = coo->Transpose()->ToCSR();
     }
+    std::atomic_store(&const_cast<ImmutableGraph*>(this)->in_csr_, in_csr);
   }
-  return in_csr_;
+  return in_csr;
 }
 
 /* !\brief Return out csr. If not exist, transpose the other one.*/
 CSRPtr ImmutableGraph::GetOutCSR() const {
-  if (!out_csr_) {
-    if (in_csr_) {
-      const_cast<ImmutableGraph*>(this)->out_csr_ = in_csr_->Transpose();
-      if (in_csr_->IsSharedMem())
+  CSRPtr out_csr = CurrentOutCSR();
+  if (out_csr) {
+    return out_csr;
+  }
+  if (compressed_out_csr_) {
+    // not cached, which would defeat the compression; see Materialize
+    return compressed_out_csr_->Decompress();
+  }
+  std::lock_guard<std::mutex> lock(out_csr_mutex_);
+  // Another thread may have built it while we were waiting.
+  out_csr = CurrentOutCSR();
+  if (!out_csr) {
+    const CSRPtr in_csr = CurrentInCSR();
+    const COOPtr coo = CurrentCOO();
+    if (in_csr) {
+      out_csr = in_csr->Transpose();
+      if (in_csr->IsSharedMem())
         LOG(WARNING) << "We just construct an out-CSR from a shared-memory in CSR. "
                      << "It may dramatically increase memory consumption.";
     } else {
-      CHECK(coo_) << "None of CSR, COO exist";
-      const_cast<ImmutableGraph*>(this)->out_csr_ = coo_->ToCSR();
+      CHECK(coo) << "None of CSR, COO exist";
+      out_csr = coo->ToCSR();
     }
+    std::atomic_store(&const_cast<ImmutableGraph*>(this)->out_csr_, out_csr);
   }
-  return out_csr_;
+  return out_csr;
 }
 
 /* !\brief Return coo. If not exist, create from csr.*/
 COOPtr ImmutableGraph::GetCOO() const {
-  if (!coo_) {
-    if (in_csr_) {
-      const_cast<ImmutableGraph*>(this)->coo_ = in_csr_->ToCOO()->Transpose();
+  COOPtr coo = CurrentCOO();
+  if (coo) {
+    return coo;
+  }
+  if (AnyCompressedCSR()) {
+    // not cached, which would defeat the compression; see Materialize
+    if (const CSRPtr in_csr = CurrentInCSR()) {
+      return in_csr->ToCOO()->Transpose();
+    }
+    return GetOutCSR()->ToCOO();
+  }
+  std::lock_guard<std::mutex> lock(coo_mutex_);
+  // Another thread may have built it while we were waiting.
+  coo = CurrentCOO();
+  if (!coo) {
+    const CSRPtr in_csr = CurrentInCSR();
+    const CSRPtr out_csr = CurrentOutCSR();
+    if (in_csr) {
+      coo = in_csr->ToCOO()->Transpose();
+    } else {
+      CHECK(out_csr) << "Both CSR are missing.";
+      coo = out_csr->ToCOO();
+    }
+    std::atomic_store(&const_cast<ImmutableGraph*>(this)->coo_, coo);
+  }
+  return coo;
+}
+
+void ImmutableGraph::Materialize(const std::vector<std::string>& formats) const {
+  std::vector<std::string> todo;
+  for (const auto& fmt : formats) {
+    CHECK(fmt == "in_csr" || fmt == "out_csr" || fmt == "coo")
+      << "Unsupported graph format: " << fmt;
+    if (std::find(todo.begin(), todo.end(), fmt) == todo.end()) {
+      todo.push_back(fmt);
+    }
+  }
+  // The formats are built one after another: the conversions are parallel
+  //   themselves and would only get one thread each in a nested region.
+  // The getters of a compressed graph do not cache what they decompress, so
+  //   the formats are stored here.
+  ImmutableGraph* self = const_cast<ImmutableGraph*>(this);
+  const bool compressed = static_cast<bool>(AnyCompressedCSR());
+  for (const auto& fmt : todo) {
+    if (fmt == "in_csr") {
+      if (compressed) {
+        std::lock_guard<std::mutex> lock(in_csr_mutex_);
+        if (!CurrentInCSR()) {
+          std::atomic_store(&self->in_csr_, GetInCSR());
+        }
+      } else {
+        GetInCSR();
+      }
+    } else if (fmt == "out_csr") {
+      if (compressed) {
+        std::lock_guard<std::mutex> lock(out_csr_mutex_);
+        if (!CurrentOutCSR()) {
+          std::atomic_store(&self->out_csr_, GetOutCSR());
+        }
+      } else {
+        GetOutCSR();
+      }
     } else {
-      CHECK(out_csr_) << "Both CSR are missing.";
-      const_cast<ImmutableGraph*>(this)->coo_ = out_csr_->ToCOO();
+      if (compressed) {
+        std::lock_guard<std::mutex> lock(coo_mutex_);
+        if (!CurrentCOO()) {
+          std::atomic_store(&self->coo_, GetCOO());
+        }
+      } else {
+        GetCOO();
+      }
     }
   }
-  return coo_;
 }
 
 EdgeArray ImmutableGraph::Edges(const std::string &order) const {
   if (order.empty()) {
     // arbitrary order
-    if (in_csr_) {
+    const CSRPtr in_csr = CurrentInCSR();
+    if (in_csr) {
       // transpose
-      const auto& edges = in_csr_->Edges(order);
+      const auto& edges = in_csr->Edges(order);
       return EdgeArray{edges.dst, edges.src, edges.id};
     } else {
       return AnyGraph()->Edges(order);
@@ -608,12 +890,31 @@ ImmutableGraphPtr ImmutableGraph::AsNumBits(ImmutableGraphPtr g, uint8_t bits) {
   }
 }
 
+ImmutableGraphPtr ImmutableGraph::Compress(ImmutableGraphPtr g) {
+  CompressedCSRPtr in_csr = g->compressed_in_csr_;
+  CompressedCSRPtr out_csr = g->compressed_out_csr_;
+  if (!in_csr) {
+    in_csr = std::make_shared<CompressedCSR>(g->GetInCSR());
+  }
+  if (!out_csr) {
+    out_csr = std::make_shared<CompressedCSR>(g->GetOutCSR());
+  }
+  return ImmutableGraphPtr(new ImmutableGraph(in_csr, out_csr));
+}
+
 ImmutableGraphPtr ImmutableGraph::Reverse() const {
-  if (coo_) {
+  if (compressed_in_csr_ || compressed_out_csr_) {
+    ImmutableGraphPtr ret(new ImmutableGraph(compressed_out_csr_, compressed_in_csr_));
+    ret->in_csr_ = CurrentOutCSR();
+    ret->out_csr_ = CurrentInCSR();
+    return ret;
+  }
+  const COOPtr coo = CurrentCOO();
+  if (coo) {
     return ImmutableGraphPtr(new ImmutableGraph(
-          out_csr_, in_csr_, coo_->Transpose()));
+          CurrentOutCSR(), CurrentInCSR(), coo->Transpose()));
   } else {
-    return ImmutableGraphPtr(new ImmutableGraph(out_csr_, in_csr_));
+    return ImmutableGraphPtr(new ImmutableGraph(CurrentOutCSR(), CurrentInCSR()));
   }
 }
 
@@ -646,4 +947,35 @@ DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphAsNumBits")
     *rv = ImmutableGraph::AsNumBits(ig, bits);
   });
 
+DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphMaterialize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GraphRef g = args[0];
+    bool in_csr = args[1];
+    bool out_csr = args[2];
+    bool coo = args[3];
+    ImmutableGraphPtr ig = CHECK_NOTNULL(std::dynamic_pointer_cast<ImmutableGraph>(g.sptr()));
+    std::vector<std::string> formats;
+    if (in_csr) formats.push_back("in_csr");
+    if (out_csr) formats.push_back("out_csr");
+    if (coo) formats.push_back("coo");
+    ig->Materialize(formats);
+  });
+
+DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphCompress")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GraphRef g = args[0];
+    ImmutableGraphPtr ig = CHECK_NOTNULL(std::dynamic_pointer_cast<ImmutableGraph>(g.sptr()));
+    *rv = ImmutableGraph::Compress(ig);
+  });
+
+DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLImmutableGraphCompressedSize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GraphRef g = args[0];
+    ImmutableGraphPtr ig = CHECK_NOTNULL(std::dynamic_pointer_cast<ImmutableGraph>(g.sptr()));
+    int64_t size = 0;
+    if (ig->GetCompressedInCSR()) size += ig->GetCompressedInCSR()->MemorySize();
+    if (ig->GetCompressedOutCSR()) size += ig->GetCompressedOutCSR()->MemorySize();
+    *rv = size;
+  });
+
 }  // namespace dgl
@@ -193,7 +193,7 @@ DGL_REGISTER_GLOBAL("network._CAPI_SenderSendNodeFlow")
     // Create a message for the meta data of ndarray
     NDArray indptr = csr->indptr();
     NDArray indice = csr->indices();
-    NDArray edge_ids = csr->edge_ids();
+    NDArray edge_ids = csr->edge_ids_or_range();
     MsgMeta msg(kNodeFlowMsg);
     msg.AddArray(node_mapping);
     msg.AddArray(edge_mapping);
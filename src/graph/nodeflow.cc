@@ -8,9 +8,11 @@
 #include <dgl/packed_func_ext.h>
 #include <dgl/nodeflow.h>
 
+#include <numeric>
 #include <string>
 
 #include "../c_api_common.h"
+#include "../array/common.h"  // for ATEN_ID_TYPE_SWITCH
 
 using dgl::runtime::DGLArgs;
 using dgl::runtime::DGLArgValue;
@@ -19,6 +21,53 @@ using dgl::runtime::PackedFunc;
 
 namespace dgl {
 
+namespace {
+// Return the given block of the NodeFlow in COO format. The returned arrays are int64.
+template <typename IdType>
+std::vector<IdArray> GetNodeFlowSliceCOO(const aten::CSRMatrix &csr, size_t layer0_size,
+                                         size_t layer1_start, size_t layer1_end, bool remap) {
+  const IdType* indptr = static_cast<IdType*>(csr.indptr->data);
+  const IdType* indices = static_cast<IdType*>(csr.indices->data);
+  // null if the edge ids are implicit
+  const IdType* edge_ids = aten::CSRHasData(csr) ? static_cast<IdType*>(csr.data->data) : nullptr;
+  int64_t nnz = indptr[layer1_end] - indptr[layer1_start];
+  IdArray idx = aten::NewIdArray(2 * nnz);
+  IdArray eid = aten::NewIdArray(nnz);
+  int64_t *idx_data = static_cast<int64_t*>(idx->data);
+  dgl_id_t *eid_data = static_cast<dgl_id_t*>(eid->data);
+  size_t num_edges = 0;
+  for (size_t i = layer1_start; i < layer1_end; i++) {
+    for (IdType j = indptr[i]; j < indptr[i + 1]; j++) {
+      // These nodes are all in a layer. We need to remap them to the node id
+      // local to the layer.
+      idx_data[num_edges] = remap ? i - layer1_start : i;
+      num_edges++;
+    }
+  }
+  CHECK_EQ(num_edges, nnz);
+  if (remap) {
+    size_t edge_start = indptr[layer1_start];
+    dgl_id_t first_eid = edge_ids ? edge_ids[edge_start] : edge_start;
+    dgl_id_t first_vid = layer1_start - layer0_size;
+    for (int64_t i = 0; i < nnz; i++) {
+      CHECK_GE(static_cast<dgl_id_t>(indices[edge_start + i]), first_vid);
+      idx_data[nnz + i] = indices[edge_start + i] - first_vid;
+      eid_data[i] = (edge_ids ? edge_ids[edge_start + i] : edge_start + i) - first_eid;
+    }
+  } else {
+    std::copy(indices + indptr[layer1_start],
+              indices + indptr[layer1_end], idx_data + nnz);
+    if (edge_ids) {
+      std::copy(edge_ids + indptr[layer1_start],
+                edge_ids + indptr[layer1_end], eid_data);
+    } else {
+      std::iota(eid_data, eid_data + nnz, indptr[layer1_start]);
+    }
+  }
+  return std::vector<IdArray>{idx, eid};
+}
+}  // namespace
+
 std::vector<IdArray> GetNodeFlowSlice(const ImmutableGraph &graph, const std::string &fmt,
                                       size_t layer0_size, size_t layer1_start,
                                       size_t layer1_end, bool remap) {
@@ -26,9 +75,15 @@ std::vector<IdArray> GetNodeFlowSlice(const ImmutableGraph &graph, const std::st
   if (fmt == std::string("csr")) {
     dgl_id_t first_vid = layer1_start - layer0_size;
     auto csr = aten::CSRSliceRows(graph.GetInCSR()->ToCSRMatrix(), layer1_start, layer1_end);
+    if (!aten::CSRHasData(csr)) {
+      csr.data = aten::Range(0, csr.indices->shape[0], csr.indices->dtype.bits,
+                             csr.indices->ctx);
+    }
     if (remap) {
-      dgl_id_t *eid_data = static_cast<dgl_id_t*>(csr.data->data);
-      const dgl_id_t first_eid = eid_data[0];
+      dgl_id_t first_eid = 0;
+      ATEN_ID_TYPE_SWITCH(csr.data->dtype, IdType, {
+        first_eid = static_cast<IdType*>(csr.data->data)[0];
+      });
       IdArray new_indices = aten::Sub(csr.indices, first_vid);
       IdArray new_data = aten::Sub(csr.data, first_eid);
       return {csr.indptr, new_indices, new_data};
@@ -37,40 +92,11 @@ std::vector<IdArray> GetNodeFlowSlice(const ImmutableGraph &graph, const std::st
     }
   } else if (fmt == std::string("coo")) {
     auto csr = graph.GetInCSR()->ToCSRMatrix();
-    const dgl_id_t* indptr = static_cast<dgl_id_t*>(csr.indptr->data);
-    const dgl_id_t* indices = static_cast<dgl_id_t*>(csr.indices->data);
-    const dgl_id_t* edge_ids = static_cast<dgl_id_t*>(csr.data->data);
-    int64_t nnz = indptr[layer1_end] - indptr[layer1_start];
-    IdArray idx = aten::NewIdArray(2 * nnz);
-    IdArray eid = aten::NewIdArray(nnz);
-    int64_t *idx_data = static_cast<int64_t*>(idx->data);
-    dgl_id_t *eid_data = static_cast<dgl_id_t*>(eid->data);
-    size_t num_edges = 0;
-    for (size_t i = layer1_start; i < layer1_end; i++) {
-      for (dgl_id_t j = indptr[i]; j < indptr[i + 1]; j++) {
-        // These nodes are all in a layer. We need to remap them to the node id
-        // local to the layer.
-        idx_data[num_edges] = remap ? i - layer1_start : i;
-        num_edges++;
-      }
-    }
-    CHECK_EQ(num_edges, nnz);
-    if (remap) {
-      size_t edge_start = indptr[layer1_start];
-      dgl_id_t first_eid = edge_ids[edge_start];
-      dgl_id_t first_vid = layer1_start - layer0_size;
-      for (int64_t i = 0; i < nnz; i++) {
-        CHECK_GE(indices[edge_start + i], first_vid);
-        idx_data[nnz + i] = indices[edge_start + i] - first_vid;
-        eid_data[i] = edge_ids[edge_start + i] - first_eid;
-      }
-    } else {
-      std::copy(indices + indptr[layer1_start],
-                indices + indptr[layer1_end], idx_data + nnz);
-      std::copy(edge_ids + indptr[layer1_start],
-                edge_ids + indptr[layer1_end], eid_data);
-    }
-    return std::vector<IdArray>{idx, eid};
+    std::vector<IdArray> ret;
+    ATEN_ID_TYPE_SWITCH(csr.indptr->dtype, IdType, {
+      ret = GetNodeFlowSliceCOO<IdType>(csr, layer0_size, layer1_start, layer1_end, remap);
+    });
+    return ret;
   } else {
     LOG(FATAL) << "unsupported adjacency matrix format";
     return {};
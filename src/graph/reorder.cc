@@ -0,0 +1,409 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file graph/reorder.cc
+ * \brief Locality-aware vertex reordering.
+ */
+#include <dgl/graph_op.h>
+#include <dgl/immutable_graph.h>
+#include <dgl/packed_func_ext.h>
+#include <dmlc/omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "../c_api_common.h"
+#include "../array/cpu/parallel_util.h"
+
+using namespace dgl::runtime;
+using dgl::aten::impl::kParallelGrainSize;
+using dgl::aten::impl::ExclusiveScan;
+
+namespace dgl {
+namespace {
+
+/*! \brief Raw in and out adjacency of a graph. */
+template <typename IdType>
+struct Adjacency {
+  int64_t num_vertices;
+  const IdType *out_indptr, *out_indices;
+  const IdType *in_indptr, *in_indices;
+
+  int64_t OutDegree(int64_t v) const { return out_indptr[v + 1] - out_indptr[v]; }
+  int64_t InDegree(int64_t v) const { return in_indptr[v + 1] - in_indptr[v]; }
+  int64_t Degree(int64_t v) const { return OutDegree(v) + InDegree(v); }
+};
+
+/*!
+ * \brief Vertices sorted by decreasing total degree.
+ *
+ * Ties are broken by the vertex id, so the order is deterministic.
+ */
+template <typename IdType>
+std::vector<IdType> DegreeOrder(const Adjacency<IdType>& adj) {
+  std::vector<IdType> order(adj.num_vertices);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&adj] (IdType a, IdType b) {
+      return adj.Degree(a) > adj.Degree(b);
+    });
+  return order;
+}
+
+/*!
+ * \brief Breadth-first search on the undirected graph that visits the neighbors
+ *        in increasing degree order (the Cuthill-McKee order).
+ *
+ * Only the vertices with level[v] == -1 are visited. On return, their level
+ * holds the BFS depth and the visited vertices are appended to order.
+ *
+ * \return the index in order of the first vertex of the last level
+ */
+template <typename IdType>
+size_t CuthillMcKeeBFS(const Adjacency<IdType>& adj, IdType source,
+                       std::vector<int64_t>* level, std::vector<IdType>* order) {
+  const size_t start = order->size();
+  size_t last_level = start;
+  std::vector<IdType> nbrs;
+  (*level)[source] = 0;
+  order->push_back(source);
+  for (size_t i = start; i < order->size(); ++i) {
+    const IdType u = (*order)[i];
+    if ((*level)[u] != (*level)[(*order)[last_level]]) {
+      last_level = i;
+    }
+    nbrs.clear();
+    for (int64_t j = adj.out_indptr[u]; j < adj.out_indptr[u + 1]; ++j) {
+      if ((*level)[adj.out_indices[j]] == -1) {
+        nbrs.push_back(adj.out_indices[j]);
+      }
+    }
+    for (int64_t j = adj.in_indptr[u]; j < adj.in_indptr[u + 1]; ++j) {
+      if ((*level)[adj.in_indices[j]] == -1) {
+        nbrs.push_back(adj.in_indices[j]);
+      }
+    }
+    std::sort(nbrs.begin(), nbrs.end(), [&adj] (IdType a, IdType b) {
+        return adj.Degree(a) < adj.Degree(b) || (adj.Degree(a) == adj.Degree(b) && a < b);
+      });
+    for (const IdType v : nbrs) {
+      if ((*level)[v] == -1) {
+        (*level)[v] = (*level)[u] + 1;
+        order->push_back(v);
+      }
+    }
+  }
+  return last_level;
+}
+
+/*!
+ * \brief Reverse Cuthill-McKee order of the undirected graph.
+ *
+ * Each connected component is started from a pseudo-peripheral vertex found
+ * by the George-Liu heuristic from its minimum degree vertex.
+ */
+template <typename IdType>
+std::vector<IdType> RCMOrder(const Adjacency<IdType>& adj) {
+  const int64_t num_vertices = adj.num_vertices;
+  // seeds are tried in increasing degree order
+  std::vector<IdType> seeds = DegreeOrder(adj);
+  std::reverse(seeds.begin(), seeds.end());
+  std::vector<int64_t> level(num_vertices, -1), probe_level(num_vertices, -1);
+  std::vector<IdType> order, probe;
+  order.reserve(num_vertices);
+  for (const IdType seed : seeds) {
+    if (level[seed] != -1) {
+      continue;
+    }
+    // move the source to a vertex of larger eccentricity while possible
+    IdType source = seed;
+    int64_t eccentricity = -1;
+    for (int iter = 0; iter < 8; ++iter) {
+      probe.clear();
+      // unvisited vertices of the component have level -1 in probe_level
+      const size_t last = CuthillMcKeeBFS(adj, source, &probe_level, &probe);
+      const int64_t depth = probe_level[probe.back()];
+      IdType candidate = probe[last];
+      for (size_t i = last; i < probe.size(); ++i) {
+        if (adj.Degree(probe[i]) < adj.Degree(candidate)) {
+          candidate = probe[i];
+        }
+      }
+      for (const IdType v : probe) {
+        probe_level[v] = -1;
+      }
+      if (depth <= eccentricity) {
+        break;
+      }
+      eccentricity = depth;
+      source = candidate;
+    }
+    CuthillMcKeeBFS(adj, source, &level, &order);
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+/*!
+ * \brief Priority queue of vertices with unit increments and decrements of
+ *        the keys in constant time, as used by Gorder.
+ *
+ * Vertices are kept in doubly linked lists bucketed by key.
+ */
+class UnitHeap {
+ public:
+  explicit UnitHeap(int64_t n)
+    : key_(n, 0), prev_(n), next_(n), removed_(n, false), head_(1, -1) {
+    for (int64_t v = n - 1; v >= 0; --v) {
+      Link(v);
+    }
+  }
+
+  void Increment(int64_t v) {
+    if (removed_[v]) return;
+    Unlink(v);
+    ++key_[v];
+    if (key_[v] >= static_cast<int64_t>(head_.size())) {
+      head_.push_back(-1);
+    }
+    top_ = std::max(top_, key_[v]);
+    Link(v);
+  }
+
+  void Decrement(int64_t v) {
+    if (removed_[v]) return;
+    Unlink(v);
+    --key_[v];
+    Link(v);
+  }
+
+  /*! \brief Remove and return a vertex of the maximum key. */
+  int64_t ExtractMax() {
+    while (head_[top_] == -1) --top_;
+    const int64_t v = head_[top_];
+    Remove(v);
+    return v;
+  }
+
+  void Remove(int64_t v) {
+    if (removed_[v]) return;
+    Unlink(v);
+    removed_[v] = true;
+  }
+
+ private:
+  void Link(int64_t v) {
+    const int64_t h = head_[key_[v]];
+    prev_[v] = -1;
+    next_[v] = h;
+    if (h != -1) prev_[h] = v;
+    head_[key_[v]] = v;
+  }
+
+  void Unlink(int64_t v) {
+    if (prev_[v] != -1) {
+      next_[prev_[v]] = next_[v];
+    } else {
+      head_[key_[v]] = next_[v];
+    }
+    if (next_[v] != -1) prev_[next_[v]] = prev_[v];
+  }
+
+  std::vector<int64_t> key_, prev_, next_;
+  std::vector<bool> removed_;
+  // the first vertex of each key bucket
+  std::vector<int64_t> head_;
+  int64_t top_ = 0;
+};
+
+/*!
+ * \brief Gorder: greedily place next the vertex sharing the most neighbors
+ *        and in-neighbors with the last window placed vertices.
+ *
+ * In-neighbors with a degree above sqrt(|V|) are not used to relate their
+ * out-neighbors, which bounds the cost on power-law graphs.
+ */
+template <typename IdType>
+std::vector<IdType> Gorder(const Adjacency<IdType>& adj, int64_t window) {
+  const int64_t num_vertices = adj.num_vertices;
+  std::vector<IdType> order;
+  order.reserve(num_vertices);
+  if (num_vertices == 0) {
+    return order;
+  }
+  const int64_t hub_degree = static_cast<int64_t>(std::sqrt(num_vertices));
+  UnitHeap heap(num_vertices);
+  // update the scores of the vertices related to v entering (+1) or leaving
+  // (-1) the window
+  auto update = [&] (IdType v, bool enter) {
+    auto bump = [&] (int64_t w) {
+      if (enter) {
+        heap.Increment(w);
+      } else {
+        heap.Decrement(w);
+      }
+    };
+    for (int64_t j = adj.out_indptr[v]; j < adj.out_indptr[v + 1]; ++j) {
+      bump(adj.out_indices[j]);
+    }
+    for (int64_t j = adj.in_indptr[v]; j < adj.in_indptr[v + 1]; ++j) {
+      const IdType u = adj.in_indices[j];
+      bump(u);
+      if (adj.OutDegree(u) <= hub_degree) {
+        for (int64_t k = adj.out_indptr[u]; k < adj.out_indptr[u + 1]; ++k) {
+          if (adj.out_indices[k] != v) {
+            bump(adj.out_indices[k]);
+          }
+        }
+      }
+    }
+  };
+  // start from the vertex of maximum in degree
+  IdType next = 0;
+  for (int64_t v = 1; v < num_vertices; ++v) {
+    if (adj.InDegree(v) > adj.InDegree(next)) {
+      next = v;
+    }
+  }
+  heap.Remove(next);
+  order.push_back(next);
+  update(next, true);
+  while (static_cast<int64_t>(order.size()) < num_vertices) {
+    if (static_cast<int64_t>(order.size()) > window) {
+      update(order[order.size() - window - 1], false);
+    }
+    next = heap.ExtractMax();
+    order.push_back(next);
+    update(next, true);
+  }
+  return order;
+}
+
+template <typename IdType>
+IdArray VertexOrder(ImmutableGraphPtr g, const std::string &method, int64_t window) {
+  const CSRPtr out_csr = g->GetOutCSR(), in_csr = g->GetInCSR();
+  const Adjacency<IdType> adj{
+    static_cast<int64_t>(g->NumVertices()),
+    static_cast<const IdType*>(out_csr->indptr()->data),
+    static_cast<const IdType*>(out_csr->indices()->data),
+    static_cast<const IdType*>(in_csr->indptr()->data),
+    static_cast<const IdType*>(in_csr->indices()->data)};
+  std::vector<IdType> order;
+  if (method == "degree") {
+    order = DegreeOrder(adj);
+  } else if (method == "rcm") {
+    order = RCMOrder(adj);
+  } else if (method == "gorder") {
+    CHECK_GT(window, 0) << "The Gorder window must be positive.";
+    order = Gorder(adj, window);
+  } else {
+    LOG(FATAL) << "Unknown vertex order: " << method;
+  }
+  return aten::VecToIdArray(order, sizeof(IdType) * 8);
+}
+
+template <typename IdType>
+ImmutableGraphPtr PermuteVertices(ImmutableGraphPtr g, IdArray perm) {
+  const int64_t num_vertices = g->NumVertices();
+  CHECK_EQ(perm->shape[0], num_vertices)
+    << "The permutation must have one entry per vertex.";
+  const IdType* perm_data = static_cast<const IdType*>(perm->data);
+  std::vector<IdType> new_ids(num_vertices, -1);
+  for (int64_t i = 0; i < num_vertices; ++i) {
+    CHECK(perm_data[i] >= 0 && perm_data[i] < num_vertices && new_ids[perm_data[i]] == -1)
+      << "Invalid permutation.";
+    new_ids[perm_data[i]] = i;
+  }
+
+  const CSRPtr csr = g->GetOutCSR();
+  const IdType* indptr_data = static_cast<const IdType*>(csr->indptr()->data);
+  const IdType* indices_data = static_cast<const IdType*>(csr->indices()->data);
+  const IdType* eid_data = csr->edge_ids().defined()
+    ? static_cast<const IdType*>(csr->edge_ids()->data) : nullptr;
+  const int64_t num_edges = csr->NumEdges();
+  const DLContext ctx{kDLCPU, 0};
+  const uint8_t bits = sizeof(IdType) * 8;
+  IdArray new_indptr = aten::NewIdArray(num_vertices + 1, ctx, bits);
+  IdArray new_indices = aten::NewIdArray(num_edges, ctx, bits);
+  IdArray new_eids = aten::NewIdArray(num_edges, ctx, bits);
+  IdType* new_indptr_data = static_cast<IdType*>(new_indptr->data);
+  IdType* new_indices_data = static_cast<IdType*>(new_indices->data);
+  IdType* new_eid_data = static_cast<IdType*>(new_eids->data);
+#pragma omp parallel for if (num_vertices >= kParallelGrainSize)
+  for (int64_t i = 0; i < num_vertices; ++i) {
+    new_indptr_data[i] = indptr_data[perm_data[i] + 1] - indptr_data[perm_data[i]];
+  }
+  new_indptr_data[num_vertices] = 0;
+  ExclusiveScan(new_indptr_data, num_vertices + 1);
+
+  // the edges keep their ids; each row is sorted by the new column ids
+#pragma omp parallel if (num_edges >= kParallelGrainSize)
+  {
+    std::vector<std::pair<IdType, IdType>> row;
+#pragma omp for schedule(dynamic, 256)
+    for (int64_t i = 0; i < num_vertices; ++i) {
+      const IdType old_start = indptr_data[perm_data[i]];
+      const IdType old_end = indptr_data[perm_data[i] + 1];
+      row.clear();
+      for (IdType j = old_start; j < old_end; ++j) {
+        row.emplace_back(new_ids[indices_data[j]], eid_data ? eid_data[j] : j);
+      }
+      std::sort(row.begin(), row.end());
+      IdType pos = new_indptr_data[i];
+      for (const auto& entry : row) {
+        new_indices_data[pos] = entry.first;
+        new_eid_data[pos] = entry.second;
+        ++pos;
+      }
+    }
+  }
+  return ImmutableGraph::CreateFromCSR(new_indptr, new_indices, new_eids,
+                                       g->IsMultigraph(), "out");
+}
+
+}  // namespace
+
+IdArray GraphOp::VertexOrder(GraphPtr graph, const std::string &method, int64_t window) {
+  ImmutableGraphPtr g = ImmutableGraph::ToImmutable(graph);
+  CHECK_EQ(g->Context().device_type, kDLCPU) << "Vertex reordering only supports CPU graphs.";
+  if (g->NumBits() == 32) {
+    return dgl::VertexOrder<int32_t>(g, method, window);
+  } else {
+    return dgl::VertexOrder<int64_t>(g, method, window);
+  }
+}
+
+ImmutableGraphPtr GraphOp::PermuteVertices(GraphPtr graph, IdArray perm) {
+  ImmutableGraphPtr g = ImmutableGraph::ToImmutable(graph);
+  CHECK_EQ(g->Context().device_type, kDLCPU) << "Vertex reordering only supports CPU graphs.";
+  perm = aten::AsNumBits(perm, g->NumBits());
+  if (g->NumBits() == 32) {
+    return dgl::PermuteVertices<int32_t>(g, perm);
+  } else {
+    return dgl::PermuteVertices<int64_t>(g, perm);
+  }
+}
+
+std::pair<ImmutableGraphPtr, IdArray> GraphOp::ReorderVertices(
+    GraphPtr graph, const std::string &method, int64_t window) {
+  IdArray perm = VertexOrder(graph, method, window);
+  return std::make_pair(PermuteVertices(graph, perm), perm);
+}
+
+DGL_REGISTER_GLOBAL("transform._CAPI_DGLVertexOrder")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GraphRef g = args[0];
+    const std::string method = args[1];
+    const int64_t window = args[2];
+    *rv = GraphOp::VertexOrder(g.sptr(), method, window);
+  });
+
+DGL_REGISTER_GLOBAL("transform._CAPI_DGLPermuteVertices")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GraphRef g = args[0];
+    const IdArray perm = args[1];
+    *rv = GraphRef(GraphOp::PermuteVertices(g.sptr(), perm));
+  });
+
+}  // namespace dgl
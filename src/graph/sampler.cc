@@ -14,7 +14,8 @@
 #include <cmath>
 #include <numeric>
 #include "../c_api_common.h"
-#include "../array/common.h"  // for ATEN_FLOAT_TYPE_SWITCH
+#include "../array/common.h"  // for ATEN_FLOAT_TYPE_SWITCH and ATEN_ID_TYPE_SWITCH
+#include "./compressed_csr.h"
 
 using namespace dgl::runtime;
 
@@ -141,8 +142,9 @@ void NegateArray(const std::vector<size_t> &nz_idxs,
 /*
  * Uniform sample vertices from a list of vertices.
  */
-void GetUniformSample(const dgl_id_t* edge_id_list,
-                      const dgl_id_t* vid_list,
+template<typename IdType>
+void GetUniformSample(const IdType* edge_id_list,
+                      const IdType* vid_list,
                       const size_t ver_len,
                       const size_t max_num_neighbor,
                       std::vector<dgl_id_t>* out_ver,
@@ -182,10 +184,10 @@ void GetUniformSample(const dgl_id_t* edge_id_list,
  *
  * \param probability Transition probability on the entire graph, indexed by edge ID
  */
-template<typename ValueType>
+template<typename IdType, typename ValueType>
 void GetNonUniformSample(const ValueType* probability,
-                         const dgl_id_t* edge_id_list,
-                         const dgl_id_t* vid_list,
+                         const IdType* edge_id_list,
+                         const IdType* vid_list,
                          const size_t ver_len,
                          const size_t max_num_neighbor,
                          std::vector<dgl_id_t>* out_ver,
@@ -238,6 +240,7 @@ struct neighbor_info {
   }
 };
 
+template<typename IdType>
 NodeFlow ConstructNodeFlow(std::vector<dgl_id_t> neighbor_list,
                            std::vector<dgl_id_t> edge_list,
                            std::vector<size_t> layer_offsets,
@@ -257,12 +260,16 @@ NodeFlow ConstructNodeFlow(std::vector<dgl_id_t> neighbor_list,
   dgl_id_t *flow_off_data = static_cast<dgl_id_t *>(nf->flow_offsets->data);
   dgl_id_t *edge_map_data = static_cast<dgl_id_t *>(nf->edge_mapping->data);
 
-  // Construct sub_csr_graph
+  // Construct sub_csr_graph using the same number of bits as the parent graph
   // TODO(minjie): is nodeflow a multigraph?
-  auto subg_csr = CSRPtr(new CSR(num_vertices, num_edges, is_multigraph));
-  dgl_id_t* indptr_out = static_cast<dgl_id_t*>(subg_csr->indptr()->data);
-  dgl_id_t* col_list_out = static_cast<dgl_id_t*>(subg_csr->indices()->data);
-  dgl_id_t* eid_out = static_cast<dgl_id_t*>(subg_csr->edge_ids()->data);
+  const uint8_t bits = sizeof(IdType) * 8;
+  const DLContext ctx = DLContext{kDLCPU, 0};
+  auto subg_csr = CSRPtr(new CSR(aten::NewIdArray(num_vertices + 1, ctx, bits),
+                                 aten::NewIdArray(num_edges, ctx, bits),
+                                 IdArray(),  // edge ids follow the CSR order
+                                 is_multigraph));
+  IdType* indptr_out = static_cast<IdType*>(subg_csr->indptr()->data);
+  IdType* col_list_out = static_cast<IdType*>(subg_csr->indices()->data);
   size_t collected_nedges = 0;
 
   // The data from the previous steps:
@@ -345,7 +352,7 @@ NodeFlow ConstructNodeFlow(std::vector<dgl_id_t> neighbor_list,
     out_layer_idx++;
   }
   CHECK_EQ(row_idx, num_vertices);
-  CHECK_EQ(indptr_out[row_idx], num_edges);
+  CHECK_EQ(static_cast<int64_t>(indptr_out[row_idx]), num_edges);
   CHECK_EQ(out_layer_idx, num_hops);
   CHECK_EQ(layer_off_data[out_layer_idx], num_vertices);
 
@@ -360,8 +367,6 @@ NodeFlow ConstructNodeFlow(std::vector<dgl_id_t> neighbor_list,
   CHECK(out_flow_idx == num_hops - 1);
   CHECK(flow_off_data[num_hops - 1] == static_cast<uint64_t>(num_edges));
 
-  std::iota(eid_out, eid_out + num_edges, 0);
-
   if (edge_type == std::string("in")) {
     nf->graph = GraphPtr(new ImmutableGraph(subg_csr, nullptr));
   } else {
@@ -371,20 +376,76 @@ NodeFlow ConstructNodeFlow(std::vector<dgl_id_t> neighbor_list,
   return nf;
 }
 
-template<typename ValueType>
-NodeFlow SampleSubgraph(const ImmutableGraph *graph,
+/*
+ * Neighbor lists of a CSR graph.
+ * If the edge ids are implicit, the edge ids returned by Get are valid until
+ * the next call.
+ */
+template<typename IdType>
+class CSRNeighbors {
+ public:
+  explicit CSRNeighbors(const CSRPtr csr)
+    : indptr_(static_cast<IdType*>(csr->indptr()->data)),
+      col_list_(static_cast<IdType*>(csr->indices()->data)),
+      val_list_(csr->edge_ids().defined() ?
+                static_cast<IdType*>(csr->edge_ids()->data) : nullptr) {}
+
+  /*
+   * Point col_list and eid_list to the neighbors and the edge ids of the vertex,
+   * and return the number of neighbors.
+   */
+  size_t Get(dgl_id_t vid, const IdType** col_list, const IdType** eid_list) {
+    const size_t len = indptr_[vid + 1] - indptr_[vid];
+    *col_list = col_list_ + indptr_[vid];
+    if (val_list_) {
+      *eid_list = val_list_ + indptr_[vid];
+    } else {
+      eid_buf_.resize(len);
+      std::iota(eid_buf_.begin(), eid_buf_.end(), indptr_[vid]);
+      *eid_list = eid_buf_.data();
+    }
+    return len;
+  }
+
+ private:
+  const IdType *indptr_, *col_list_, *val_list_;
+  std::vector<IdType> eid_buf_;
+};
+
+/*
+ * Neighbor lists of a compressed CSR graph, decoded on demand.
+ * The lists returned by Get are valid until the next call.
+ */
+template<typename IdType>
+class CompressedCSRNeighbors {
+ public:
+  explicit CompressedCSRNeighbors(const CompressedCSRPtr csr): csr_(csr) {}
+
+  size_t Get(dgl_id_t vid, const IdType** col_list, const IdType** eid_list) {
+    const size_t len = csr_->RowNNZ(vid);
+    col_buf_.resize(len);
+    eid_buf_.resize(len);
+    csr_->DecodeRow<IdType>(vid, col_buf_.data(), eid_buf_.data());
+    *col_list = col_buf_.data();
+    *eid_list = eid_buf_.data();
+    return len;
+  }
+
+ private:
+  const CompressedCSRPtr csr_;
+  std::vector<IdType> col_buf_, eid_buf_;
+};
+
+template<typename IdType, typename ValueType, typename Neighbors>
+NodeFlow SampleSubgraph(Neighbors* neighbors,
+                        bool is_multigraph,
                         const std::vector<dgl_id_t>& seeds,
                         const ValueType* probability,
                         const std::string &edge_type,
                         int num_hops,
                         size_t num_neighbor,
                         const bool add_self_loop) {
-  CHECK_EQ(graph->NumBits(), 64) << "32 bit graph is not supported yet";
   const size_t num_seeds = seeds.size();
-  auto orig_csr = edge_type == "in" ? graph->GetInCSR() : graph->GetOutCSR();
-  const dgl_id_t* val_list = static_cast<dgl_id_t*>(orig_csr->edge_ids()->data);
-  const dgl_id_t* col_list = static_cast<dgl_id_t*>(orig_csr->indices()->data);
-  const dgl_id_t* indptr = static_cast<dgl_id_t*>(orig_csr->indptr()->data);
 
   std::unordered_set<dgl_id_t> sub_ver_map;  // The vertex Ids in a layer.
   std::vector<std::pair<dgl_id_t, int> > sub_vers;
@@ -422,18 +483,19 @@ NodeFlow SampleSubgraph(const ImmutableGraph *graph,
 
       tmp_sampled_src_list.clear();
       tmp_sampled_edge_list.clear();
-      dgl_id_t ver_len = *(indptr+dst_id+1) - *(indptr+dst_id);
+      const IdType *src_list, *eid_list;
+      const size_t ver_len = neighbors->Get(dst_id, &src_list, &eid_list);
       if (probability == nullptr) {  // uniform-sample
-        GetUniformSample(val_list + *(indptr + dst_id),
-                         col_list + *(indptr + dst_id),
+        GetUniformSample(eid_list,
+                         src_list,
                          ver_len,
                          num_neighbor,
                          &tmp_sampled_src_list,
                          &tmp_sampled_edge_list);
       } else {  // non-uniform-sample
         GetNonUniformSample(probability,
-                            val_list + *(indptr + dst_id),
-                            col_list + *(indptr + dst_id),
+                            eid_list,
+                            src_list,
                             ver_len,
                             num_neighbor,
                             &tmp_sampled_src_list,
@@ -443,10 +505,9 @@ NodeFlow SampleSubgraph(const ImmutableGraph *graph,
       if (add_self_loop && std::find(tmp_sampled_src_list.begin(), tmp_sampled_src_list.end(),
                                      dst_id) == tmp_sampled_src_list.end()) {
         tmp_sampled_src_list.push_back(dst_id);
-        const dgl_id_t *src_list = col_list + *(indptr + dst_id);
-        const dgl_id_t *eid_list = val_list + *(indptr + dst_id);
         // TODO(zhengda) this operation has O(N) complexity. It can be pretty slow.
-        const dgl_id_t *src = std::find(src_list, src_list + ver_len, dst_id);
+        const IdType *src = std::find(src_list, src_list + ver_len,
+                                      static_cast<IdType>(dst_id));
         // If there doesn't exist a self loop in the graph.
         // we have to add -1 as the edge id for the self-loop edge.
         if (src == src_list + ver_len)
@@ -480,8 +541,38 @@ NodeFlow SampleSubgraph(const ImmutableGraph *graph,
     CHECK_EQ(layer_offsets[layer_id + 1], sub_vers.size());
   }
 
-  return ConstructNodeFlow(neighbor_list, edge_list, layer_offsets, &sub_vers, &neigh_pos,
-                           edge_type, num_edges, num_hops, graph->IsMultigraph());
+  return ConstructNodeFlow<IdType>(neighbor_list, edge_list, layer_offsets, &sub_vers,
+                                   &neigh_pos, edge_type, num_edges, num_hops,
+                                   is_multigraph);
+}
+
+template<typename ValueType>
+NodeFlow SampleSubgraph(const ImmutableGraph *graph,
+                        const std::vector<dgl_id_t>& seeds,
+                        const ValueType* probability,
+                        const std::string &edge_type,
+                        int num_hops,
+                        size_t num_neighbor,
+                        const bool add_self_loop) {
+  NodeFlow nf;
+  // Sample directly from the compressed CSR if the graph has one.
+  const CompressedCSRPtr compressed_csr = edge_type == "in" ?
+    graph->GetCompressedInCSR() : graph->GetCompressedOutCSR();
+  if (compressed_csr) {
+    ATEN_ID_TYPE_SWITCH(compressed_csr->indptr()->dtype, IdType, {
+      CompressedCSRNeighbors<IdType> neighbors(compressed_csr);
+      nf = SampleSubgraph<IdType>(&neighbors, graph->IsMultigraph(), seeds, probability,
+                                  edge_type, num_hops, num_neighbor, add_self_loop);
+    });
+    return nf;
+  }
+  auto orig_csr = edge_type == "in" ? graph->GetInCSR() : graph->GetOutCSR();
+  ATEN_ID_TYPE_SWITCH(orig_csr->indptr()->dtype, IdType, {
+    CSRNeighbors<IdType> neighbors(orig_csr);
+    nf = SampleSubgraph<IdType>(&neighbors, graph->IsMultigraph(), seeds, probability,
+                                edge_type, num_hops, num_neighbor, add_self_loop);
+  });
+  return nf;
 }
 
 }  // namespace
@@ -533,8 +624,8 @@ NodeFlow SamplerOp::NeighborSample(const ImmutableGraph *graph,
 }
 
 namespace {
-  void ConstructLayers(const dgl_id_t *indptr,
-                       const dgl_id_t *indices,
+  template<typename IdType, typename Neighbors>
+  void ConstructLayers(Neighbors *neighbors,
                        const std::vector<dgl_id_t>& seed_array,
                        IdArray layer_sizes,
                        std::vector<dgl_id_t> *layer_offsets,
@@ -558,8 +649,9 @@ namespace {
       const int64_t layer_size = layer_sizes_data[i];
       std::unordered_set<dgl_id_t> candidate_set;
       for (auto j = curr; j != next; ++j) {
-        auto src = (*node_mapping)[j];
-        candidate_set.insert(indices + indptr[src], indices + indptr[src + 1]);
+        const IdType *col_list, *eid_list;
+        const size_t len = neighbors->Get((*node_mapping)[j], &col_list, &eid_list);
+        candidate_set.insert(col_list, col_list + len);
       }
 
       std::vector<dgl_id_t> candidate_vector;
@@ -594,14 +686,12 @@ namespace {
     }
   }
 
-  void ConstructFlows(const dgl_id_t *indptr,
-                      const dgl_id_t *indices,
-                      const dgl_id_t *eids,
+  template<typename IdType, typename Neighbors>
+  void ConstructFlows(Neighbors *neighbors,
                       const std::vector<dgl_id_t> &node_mapping,
                       const std::vector<int64_t> &actl_layer_sizes,
                       std::vector<dgl_id_t> *sub_indptr,
                       std::vector<dgl_id_t> *sub_indices,
-                      std::vector<dgl_id_t> *sub_eids,
                       std::vector<dgl_id_t> *flow_offsets,
                       std::vector<dgl_id_t> *edge_mapping) {
     /*
@@ -624,11 +714,13 @@ namespace {
         auto dst = node_mapping[first + src_size + j];
         typedef std::pair<dgl_id_t, dgl_id_t> id_pair;
         std::vector<id_pair> neighbor_indices;
-        for (dgl_id_t k = indptr[dst]; k < indptr[dst + 1]; ++k) {
+        const IdType *col_list, *eid_list;
+        const size_t len = neighbors->Get(dst, &col_list, &eid_list);
+        for (size_t k = 0; k < len; ++k) {
           // TODO(gaiyu): accelerate hash table lookup
-          auto ret = source_map.find(indices[k]);
+          auto ret = source_map.find(col_list[k]);
           if (ret != source_map.end()) {
-            neighbor_indices.push_back(std::make_pair(ret->second, eids[k]));
+            neighbor_indices.push_back(std::make_pair(ret->second, eid_list[k]));
           }
         }
         auto cmp = [](const id_pair p, const id_pair q)->bool { return p.first < q.first; };
@@ -642,8 +734,34 @@ namespace {
       flow_offsets->push_back(sub_indices->size());
       first += src_size;
     }
-    sub_eids->resize(sub_indices->size());
-    std::iota(sub_eids->begin(), sub_eids->end(), 0);
+  }
+
+  template<typename IdType, typename Neighbors>
+  void ConstructLayersAndFlows(Neighbors *neighbors,
+                               const std::vector<dgl_id_t>& seeds,
+                               IdArray layer_sizes,
+                               std::vector<dgl_id_t> *layer_offsets,
+                               std::vector<dgl_id_t> *node_mapping,
+                               std::vector<float> *probabilities,
+                               std::vector<dgl_id_t> *sub_indptr,
+                               std::vector<dgl_id_t> *sub_indices,
+                               std::vector<dgl_id_t> *flow_offsets,
+                               std::vector<dgl_id_t> *edge_mapping) {
+    std::vector<int64_t> actl_layer_sizes;
+    ConstructLayers<IdType>(neighbors,
+                            seeds,
+                            layer_sizes,
+                            layer_offsets,
+                            node_mapping,
+                            &actl_layer_sizes,
+                            probabilities);
+    ConstructFlows<IdType>(neighbors,
+                           *node_mapping,
+                           actl_layer_sizes,
+                           sub_indptr,
+                           sub_indices,
+                           flow_offsets,
+                           edge_mapping);
   }
 }  // namespace
 
@@ -651,47 +769,42 @@ NodeFlow SamplerOp::LayerUniformSample(const ImmutableGraph *graph,
                                        const std::vector<dgl_id_t>& seeds,
                                        const std::string &neighbor_type,
                                        IdArray layer_sizes) {
-  const auto g_csr = neighbor_type == "in" ? graph->GetInCSR() : graph->GetOutCSR();
-  const dgl_id_t *indptr = static_cast<dgl_id_t*>(g_csr->indptr()->data);
-  const dgl_id_t *indices = static_cast<dgl_id_t*>(g_csr->indices()->data);
-  const dgl_id_t *eids = static_cast<dgl_id_t*>(g_csr->edge_ids()->data);
-
   std::vector<dgl_id_t> layer_offsets;
   std::vector<dgl_id_t> node_mapping;
-  std::vector<int64_t> actl_layer_sizes;
   std::vector<float> probabilities;
-  ConstructLayers(indptr,
-                  indices,
-                  seeds,
-                  layer_sizes,
-                  &layer_offsets,
-                  &node_mapping,
-                  &actl_layer_sizes,
-                  &probabilities);
-
-  std::vector<dgl_id_t> sub_indptr, sub_indices, sub_edge_ids;
+  std::vector<dgl_id_t> sub_indptr, sub_indices;
   std::vector<dgl_id_t> flow_offsets;
   std::vector<dgl_id_t> edge_mapping;
-  ConstructFlows(indptr,
-                 indices,
-                 eids,
-                 node_mapping,
-                 actl_layer_sizes,
-                 &sub_indptr,
-                 &sub_indices,
-                 &sub_edge_ids,
-                 &flow_offsets,
-                 &edge_mapping);
+  // Sample directly from the compressed CSR if the graph has one.
+  const CompressedCSRPtr compressed_csr = neighbor_type == "in" ?
+    graph->GetCompressedInCSR() : graph->GetCompressedOutCSR();
+  if (compressed_csr) {
+    ATEN_ID_TYPE_SWITCH(compressed_csr->indptr()->dtype, IdType, {
+      CompressedCSRNeighbors<IdType> neighbors(compressed_csr);
+      ConstructLayersAndFlows<IdType>(&neighbors, seeds, layer_sizes, &layer_offsets,
+                                      &node_mapping, &probabilities, &sub_indptr,
+                                      &sub_indices, &flow_offsets, &edge_mapping);
+    });
+  } else {
+    const auto g_csr = neighbor_type == "in" ? graph->GetInCSR() : graph->GetOutCSR();
+    ATEN_ID_TYPE_SWITCH(g_csr->indptr()->dtype, IdType, {
+      CSRNeighbors<IdType> neighbors(g_csr);
+      ConstructLayersAndFlows<IdType>(&neighbors, seeds, layer_sizes, &layer_offsets,
+                                      &node_mapping, &probabilities, &sub_indptr,
+                                      &sub_indices, &flow_offsets, &edge_mapping);
+    });
+  }
   // sanity check
   CHECK_GT(sub_indptr.size(), 0);
   CHECK_EQ(sub_indptr[0], 0);
   CHECK_EQ(sub_indptr.back(), sub_indices.size());
-  CHECK_EQ(sub_indices.size(), sub_edge_ids.size());
 
   NodeFlow nf = NodeFlow::Create();
-  auto sub_csr = CSRPtr(new CSR(aten::VecToIdArray(sub_indptr),
-                                aten::VecToIdArray(sub_indices),
-                                aten::VecToIdArray(sub_edge_ids)));
+  // the NodeFlow graph uses the same number of bits as the parent graph
+  const uint8_t bits = graph->NumBits();
+  auto sub_csr = CSRPtr(new CSR(aten::VecToIdArray(sub_indptr, bits),
+                                aten::VecToIdArray(sub_indices, bits),
+                                IdArray()));
 
   if (neighbor_type == std::string("in")) {
     nf->graph = GraphPtr(new ImmutableGraph(sub_csr, nullptr));
@@ -707,18 +820,6 @@ NodeFlow SamplerOp::LayerUniformSample(const ImmutableGraph *graph,
   return nf;
 }
 
-void BuildCsr(const ImmutableGraph &g, const std::string neigh_type) {
-  if (neigh_type == "in") {
-    auto csr = g.GetInCSR();
-    assert(csr);
-  } else if (neigh_type == "out") {
-    auto csr = g.GetOutCSR();
-    assert(csr);
-  } else {
-    LOG(FATAL) << "We don't support sample from neighbor type " << neigh_type;
-  }
-}
-
 template<typename ValueType>
 std::vector<NodeFlow> NeighborSamplingImpl(const ImmutableGraphPtr gptr,
                                            const IdArray seed_nodes,
@@ -736,8 +837,13 @@ std::vector<NodeFlow> NeighborSamplingImpl(const ImmutableGraphPtr gptr,
     const int64_t num_seeds = seed_nodes->shape[0];
     const int64_t num_workers = std::min(max_num_workers,
         (num_seeds + batch_size - 1) / batch_size - batch_start_id);
-    // We need to make sure we have the right CSR before we enter parallel sampling.
-    BuildCsr(*gptr, neigh_type);
+    CHECK(neigh_type == "in" || neigh_type == "out")
+      << "We don't support sample from neighbor type " << neigh_type;
+    // Build the CSR up front so that no sampling worker has to wait for it.
+    //   Compressed CSRs are sampled from directly.
+    if (!(neigh_type == "in" ? gptr->GetCompressedInCSR() : gptr->GetCompressedOutCSR())) {
+      gptr->Materialize({neigh_type == "in" ? "in_csr" : "out_csr"});
+    }
     // generate node flows
     std::vector<NodeFlow> nflows(num_workers);
 #pragma omp parallel for
@@ -846,8 +952,10 @@ DGL_REGISTER_GLOBAL("sampling._CAPI_LayerSampling")
     const int64_t num_seeds = seed_nodes->shape[0];
     const int64_t num_workers = std::min(max_num_workers,
         (num_seeds + batch_size - 1) / batch_size - batch_start_id);
-    // We need to make sure we have the right CSR before we enter parallel sampling.
-    BuildCsr(*gptr, neigh_type);
+    CHECK(neigh_type == "in" || neigh_type == "out")
+      << "We don't support sample from neighbor type " << neigh_type;
+    // Build the CSR up front so that no sampling worker has to wait for it.
+    gptr->Materialize({neigh_type == "in" ? "in_csr" : "out_csr"});
     // generate node flows
     std::vector<NodeFlow> nflows(num_workers);
 #pragma omp parallel for
@@ -4,8 +4,10 @@
  * \brief Binary reduce C APIs and definitions.
  */
 #include <dgl/packed_func_ext.h>
+#include <dgl/runtime/container.h>
 #include "./binary_reduce.h"
 #include "./common.h"
+#include "./profiler.h"
 #include "./binary_reduce_impl_decl.h"
 #include "./utils.h"
 #include "../c_api_common.h"
@@ -188,6 +190,21 @@ inline void CheckIdArray(
   }
 }
 
+// Check the shape of the optional per-edge cache of the binary op result.
+// The cache has one row per edge and the same feature shape as the output.
+inline void CheckEdgeCache(
+    const ImmutableGraph* graph, NDArray out_data, NDArray edge_cache) {
+  if (utils::IsNoneArray(edge_cache)) {
+    return;
+  }
+  CHECK_EQ(edge_cache->shape[0], graph->NumEdges())
+    << "Expected the edge cache to have one row per edge. But got "
+    << edge_cache->shape[0] << " rows for " << graph->NumEdges() << " edges.";
+  CHECK_EQ(utils::ComputeXLength(edge_cache), utils::ComputeXLength(out_data))
+    << "Expected the edge cache to have feature shape " << ShapeString(out_data)
+    << ". But got " << ShapeString(edge_cache) << ".";
+}
+
 // Return true if the operator is commutative and lhs and rhs need
 // to be switched. For example, Add(kDst, kSrc) needs to be changed
 // to Add(kSrc, kDst).
@@ -231,12 +248,15 @@ void BinaryOpReduce(
     NDArray lhs_data, NDArray rhs_data,
     NDArray out_data,
     NDArray lhs_mapping, NDArray rhs_mapping,
-    NDArray out_mapping) {
+    NDArray out_mapping,
+    NDArray edge_cache) {
   const auto& ctx = graph->Context();
   // sanity check
   CheckCtx(ctx,
-      {lhs_data, rhs_data, out_data, lhs_mapping, rhs_mapping, out_mapping},
-      {"lhs_data", "rhs_data", "out_data", "lhs_mapping", "rhs_mapping", "out_mapping"});
+      {lhs_data, rhs_data, out_data, lhs_mapping, rhs_mapping, out_mapping, edge_cache},
+      {"lhs_data", "rhs_data", "out_data", "lhs_mapping", "rhs_mapping", "out_mapping",
+       "edge_cache"});
+  CheckEdgeCache(graph, out_data, edge_cache);
   CheckIdArray(graph->NumBits(),
       {lhs_mapping, rhs_mapping, out_mapping},
       {"lhs_mapping", "rhs_mapping", "out_mapping"});
@@ -244,7 +264,7 @@ void BinaryOpReduce(
   if (NeedSwitchOrder(op, lhs, rhs)) {
     BinaryOpReduce(reducer, op, graph,
         rhs, lhs, rhs_data, lhs_data, out_data,
-        rhs_mapping, lhs_mapping, out_mapping);
+        rhs_mapping, lhs_mapping, out_mapping, edge_cache);
   } else {
     if (HasBcast(lhs_data, rhs_data)) {
       BcastInfo info = CalcBcastInfo(lhs_data, rhs_data);
@@ -252,7 +272,7 @@ void BinaryOpReduce(
           info, reducer, op, graph,
           lhs, rhs,
           lhs_data, rhs_data, out_data,
-          lhs_mapping, rhs_mapping, out_mapping);
+          lhs_mapping, rhs_mapping, out_mapping, edge_cache);
     } else {
       CHECK(IsValidBinaryOpShape(lhs_data, rhs_data))
         << "Cannot compute binary operation between feature shapes "
@@ -261,7 +281,7 @@ void BinaryOpReduce(
           reducer, op, graph,
           lhs, rhs,
           lhs_data, rhs_data, out_data,
-          lhs_mapping, rhs_mapping, out_mapping);
+          lhs_mapping, rhs_mapping, out_mapping, edge_cache);
     }
   }
 }
@@ -279,13 +299,19 @@ DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelBinaryOpReduce")
     NDArray lhs_mapping = args[8];
     NDArray rhs_mapping = args[9];
     NDArray out_mapping = args[10];
+    NDArray edge_cache = args[11];
 
     auto igptr = std::dynamic_pointer_cast<ImmutableGraph>(g.sptr());
     CHECK(igptr) << "Invalid graph object argument. Must be an immutable graph.";
+    KernelProfileScope prof("BinaryOpReduce");
+    if (prof.Active()) {
+      prof.Annotate(op, reducer, lhs, rhs, igptr.get(), out_data,
+          {lhs_data, rhs_data, out_data, lhs_mapping, rhs_mapping, out_mapping});
+    }
     BinaryOpReduce(reducer, op, igptr.get(),
         static_cast<binary_op::Target>(lhs), static_cast<binary_op::Target>(rhs),
         lhs_data, rhs_data, out_data,
-        lhs_mapping, rhs_mapping, out_mapping);
+        lhs_mapping, rhs_mapping, out_mapping, edge_cache);
   });
 
 void BackwardLhsBinaryOpReduce(
@@ -300,14 +326,16 @@ void BackwardLhsBinaryOpReduce(
     NDArray rhs_data,
     NDArray out_data,
     NDArray grad_out_data,
-    NDArray grad_lhs_data) {
+    NDArray grad_lhs_data,
+    NDArray edge_cache) {
   const auto& ctx = graph->Context();
   // sanity check
   CheckCtx(ctx,
       {lhs_data, rhs_data, out_data, grad_out_data, grad_lhs_data,
-       lhs_mapping, rhs_mapping, out_mapping},
+       lhs_mapping, rhs_mapping, out_mapping, edge_cache},
       {"lhs_data", "rhs_data", "out_data", "grad_out_data", "grad_lhs_data",
-       "lhs_mapping", "rhs_mapping", "out_mapping"});
+       "lhs_mapping", "rhs_mapping", "out_mapping", "edge_cache"});
+  CheckEdgeCache(graph, out_data, edge_cache);
   CheckIdArray(graph->NumBits(),
       {lhs_mapping, rhs_mapping, out_mapping},
       {"lhs_mapping", "rhs_mapping", "out_mapping"});
@@ -317,7 +345,7 @@ void BackwardLhsBinaryOpReduce(
         rhs, lhs,
         rhs_mapping, lhs_mapping, out_mapping,
         rhs_data, lhs_data, out_data,
-        grad_out_data, grad_lhs_data);
+        grad_out_data, grad_lhs_data, edge_cache);
   } else {
     if (HasBcast(lhs_data, rhs_data)) {
       BcastInfo info = CalcBcastInfo(lhs_data, rhs_data);
@@ -326,14 +354,14 @@ void BackwardLhsBinaryOpReduce(
           lhs, rhs,
           lhs_mapping, rhs_mapping, out_mapping,
           lhs_data, rhs_data, out_data, grad_out_data,
-          grad_lhs_data, utils::NoneArray());
+          grad_lhs_data, utils::NoneArray(), edge_cache);
     } else {
       DGL_XPU_SWITCH(ctx.device_type, BackwardBinaryReduceImpl,
           reducer, op, graph,
           lhs, rhs,
           lhs_mapping, rhs_mapping, out_mapping,
           lhs_data, rhs_data, out_data, grad_out_data,
-          grad_lhs_data, utils::NoneArray());
+          grad_lhs_data, utils::NoneArray(), edge_cache);
     }
   }
 }
@@ -353,15 +381,22 @@ DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelBackwardLhsBinaryOpReduce")
     NDArray out_data = args[10];
     NDArray grad_out_data = args[11];
     NDArray grad_lhs_data = args[12];
+    NDArray edge_cache = args[13];
 
     auto igptr = std::dynamic_pointer_cast<ImmutableGraph>(g.sptr());
     CHECK(igptr) << "Invalid graph object argument. Must be an immutable graph.";
+    KernelProfileScope prof("BackwardLhsBinaryOpReduce");
+    if (prof.Active()) {
+      prof.Annotate(op, reducer, lhs, rhs, igptr.get(), grad_lhs_data,
+          {lhs_data, rhs_data, out_data, grad_out_data, grad_lhs_data,
+           lhs_mapping, rhs_mapping, out_mapping});
+    }
     BackwardLhsBinaryOpReduce(
         reducer, op, igptr.get(),
         static_cast<binary_op::Target>(lhs), static_cast<binary_op::Target>(rhs),
         lhs_mapping, rhs_mapping, out_mapping,
         lhs_data, rhs_data, out_data, grad_out_data,
-        grad_lhs_data);
+        grad_lhs_data, edge_cache);
   });
 
 void BackwardRhsBinaryOpReduce(
@@ -376,14 +411,16 @@ void BackwardRhsBinaryOpReduce(
     NDArray rhs_data,
     NDArray out_data,
     NDArray grad_out_data,
-    NDArray grad_rhs_data) {
+    NDArray grad_rhs_data,
+    NDArray edge_cache) {
   const auto& ctx = graph->Context();
   // sanity check
   CheckCtx(ctx,
       {lhs_data, rhs_data, out_data, grad_out_data, grad_rhs_data,
-       lhs_mapping, rhs_mapping, out_mapping},
+       lhs_mapping, rhs_mapping, out_mapping, edge_cache},
       {"lhs_data", "rhs_data", "out_data", "grad_out_data", "grad_rhs_data",
-       "lhs_mapping", "rhs_mapping", "out_mapping"});
+       "lhs_mapping", "rhs_mapping", "out_mapping", "edge_cache"});
+  CheckEdgeCache(graph, out_data, edge_cache);
   CheckIdArray(graph->NumBits(),
       {lhs_mapping, rhs_mapping, out_mapping},
       {"lhs_mapping", "rhs_mapping", "out_mapping"});
@@ -392,7 +429,7 @@ void BackwardRhsBinaryOpReduce(
         rhs, lhs,
         rhs_mapping, lhs_mapping, out_mapping,
         rhs_data, lhs_data, out_data,
-        grad_out_data, grad_rhs_data);
+        grad_out_data, grad_rhs_data, edge_cache);
   } else {
     if (HasBcast(lhs_data, rhs_data)) {
       BcastInfo info = CalcBcastInfo(lhs_data, rhs_data);
@@ -401,14 +438,14 @@ void BackwardRhsBinaryOpReduce(
           lhs, rhs,
           lhs_mapping, rhs_mapping, out_mapping,
           lhs_data, rhs_data, out_data, grad_out_data,
-          utils::NoneArray(), grad_rhs_data);
+          utils::NoneArray(), grad_rhs_data, edge_cache);
     } else {
       DGL_XPU_SWITCH(ctx.device_type, BackwardBinaryReduceImpl,
           reducer, op, graph,
           lhs, rhs,
           lhs_mapping, rhs_mapping, out_mapping,
           lhs_data, rhs_data, out_data, grad_out_data,
-          utils::NoneArray(), grad_rhs_data);
+          utils::NoneArray(), grad_rhs_data, edge_cache);
     }
   }
 }
@@ -428,15 +465,22 @@ DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelBackwardRhsBinaryOpReduce")
     NDArray out_data = args[10];
     NDArray grad_out_data = args[11];
     NDArray grad_rhs_data = args[12];
+    NDArray edge_cache = args[13];
 
     auto igptr = std::dynamic_pointer_cast<ImmutableGraph>(g.sptr());
     CHECK(igptr) << "Invalid graph object argument. Must be an immutable graph.";
+    KernelProfileScope prof("BackwardRhsBinaryOpReduce");
+    if (prof.Active()) {
+      prof.Annotate(op, reducer, lhs, rhs, igptr.get(), grad_rhs_data,
+          {lhs_data, rhs_data, out_data, grad_out_data, grad_rhs_data,
+           lhs_mapping, rhs_mapping, out_mapping});
+    }
     BackwardRhsBinaryOpReduce(
         reducer, op, igptr.get(),
         static_cast<binary_op::Target>(lhs), static_cast<binary_op::Target>(rhs),
         lhs_mapping, rhs_mapping, out_mapping,
         lhs_data, rhs_data, out_data, grad_out_data,
-        grad_rhs_data);
+        grad_rhs_data, edge_cache);
   });
 
 void CopyReduce(
@@ -457,7 +501,7 @@ void CopyReduce(
       reducer, binary_op::kUseLhs, graph,
       target, binary_op::kNone,
       in_data, utils::NoneArray(), out_data,
-      in_mapping, utils::NoneArray(), out_mapping);
+      in_mapping, utils::NoneArray(), out_mapping, utils::NoneArray());
 }
 
 DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelCopyReduce")
@@ -472,6 +516,11 @@ DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelCopyReduce")
 
     auto igptr = std::dynamic_pointer_cast<ImmutableGraph>(g.sptr());
     CHECK(igptr) << "Invalid graph object argument. Must be an immutable graph.";
+    KernelProfileScope prof("CopyReduce");
+    if (prof.Active()) {
+      prof.Annotate(binary_op::kUseLhs, reducer, target, binary_op::kNone,
+          igptr.get(), out_data, {in_data, out_data, in_mapping, out_mapping});
+    }
     CopyReduce(reducer, igptr.get(),
         static_cast<binary_op::Target>(target),
         in_data, out_data,
@@ -505,7 +554,7 @@ void BackwardCopyReduce(
       target, binary_op::kNone,
       in_mapping, utils::NoneArray(), out_mapping,
       in_data, utils::NoneArray(), out_data, grad_out_data,
-      grad_in_data, utils::NoneArray());
+      grad_in_data, utils::NoneArray(), utils::NoneArray());
 }
 
 DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelBackwardCopyReduce")
@@ -522,6 +571,12 @@ DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelBackwardCopyReduce")
 
     auto igptr = std::dynamic_pointer_cast<ImmutableGraph>(g.sptr());
     CHECK(igptr) << "Invalid graph object argument. Must be an immutable graph.";
+    KernelProfileScope prof("BackwardCopyReduce");
+    if (prof.Active()) {
+      prof.Annotate(binary_op::kUseLhs, reducer, target, binary_op::kNone,
+          igptr.get(), grad_in_data,
+          {in_data, out_data, grad_out_data, grad_in_data, in_mapping, out_mapping});
+    }
     BackwardCopyReduce(
         reducer, igptr.get(), static_cast<binary_op::Target>(target),
         in_mapping, out_mapping,
@@ -529,5 +584,80 @@ DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelBackwardCopyReduce")
         grad_in_data);
   });
 
+void HeteroCopyReduce(
+    const std::string& reducer,
+    const BaseHeteroGraph* graph,
+    dgl_type_t dst_vtype,
+    binary_op::Target target,
+    const std::vector<NDArray>& in_data,
+    NDArray etype_weight,
+    NDArray out_data) {
+  const auto& ctx = graph->Context();
+  CHECK_EQ(ctx.device_type, kDLCPU) << "HeteroCopyReduce only supports CPU.";
+  CHECK(reducer != binary_op::kReduceNone)
+    << "HeteroCopyReduce requires a reducer other than \"none\".";
+  CHECK(target == binary_op::kSrc || target == binary_op::kEdge)
+    << "HeteroCopyReduce only supports src or edge target.";
+  CHECK_LT(dst_vtype, graph->NumVertexTypes()) << "Invalid vertex type: " << dst_vtype;
+  CHECK_EQ(in_data.size(), graph->NumEdgeTypes())
+    << "Expected one input tensor per edge type.";
+  CHECK_EQ(out_data->shape[0], graph->NumVertices(dst_vtype))
+    << "The output tensor must have one row per destination node.";
+  // sanity check
+  CheckCtx(ctx, in_data, std::vector<std::string>(in_data.size(), "in_data"));
+  CheckCtx(ctx, {etype_weight, out_data}, {"etype_weight", "out_data"});
+  if (!utils::IsNoneArray(etype_weight)) {
+    CHECK_EQ(etype_weight->ndim, 1);
+    CHECK_EQ(etype_weight->shape[0], graph->NumEdgeTypes())
+      << "Expected one weight per edge type.";
+    CHECK(etype_weight->dtype.code == out_data->dtype.code
+          && etype_weight->dtype.bits == out_data->dtype.bits)
+      << "The relation weight must have the same dtype as the output.";
+  }
+  const auto meta_graph = graph->meta_graph();
+  for (dgl_type_t etype = 0; etype < graph->NumEdgeTypes(); ++etype) {
+    if (utils::IsNoneArray(in_data[etype])) {
+      continue;
+    }
+    const auto pair = meta_graph->FindEdge(etype);
+    if (pair.second != dst_vtype) {
+      continue;
+    }
+    const auto& in = in_data[etype];
+    CHECK(IsValidBinaryOpShape(in, out_data))
+      << "Cannot copy feature shape " << ShapeString(in) << " of edge type "
+      << etype << " to feature shape " << ShapeString(out_data);
+    CHECK(in->dtype.code == out_data->dtype.code
+          && in->dtype.bits == out_data->dtype.bits)
+      << "The input and output tensors must have the same dtype.";
+    const int64_t num_rows = (target == binary_op::kSrc)?
+      graph->NumVertices(pair.first) : graph->NumEdges(etype);
+    CHECK_EQ(in->shape[0], num_rows)
+      << "Invalid number of rows of the input tensor of edge type " << etype;
+  }
+  HeteroCopyReduceImpl<kDLCPU>(
+      reducer, graph, dst_vtype, target, in_data, etype_weight, out_data);
+}
+
+DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelHeteroCopyReduce")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    std::string reducer = args[0];
+    HeteroGraphRef g = args[1];
+    dgl_type_t dst_vtype = args[2];
+    int target = args[3];
+    List<Value> in_data = args[4];
+    NDArray etype_weight = args[5];
+    NDArray out_data = args[6];
+
+    std::vector<NDArray> in_vec;
+    in_vec.reserve(in_data.size());
+    for (Value val : in_data) {
+      in_vec.push_back(val->data);
+    }
+    HeteroCopyReduce(reducer, g.sptr().get(), dst_vtype,
+        static_cast<binary_op::Target>(target),
+        in_vec, etype_weight, out_data);
+  });
+
 }  // namespace kernel
 }  // namespace dgl
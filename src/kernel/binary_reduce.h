@@ -8,6 +8,7 @@
 
 #include <dgl/runtime/ndarray.h>
 #include <dgl/immutable_graph.h>
+#include <dgl/base_heterograph.h>
 
 #include <vector>
 #include <string>
@@ -79,6 +80,10 @@ std::vector<int64_t> InferBinaryFeatureShape(
  * \param lhs_mapping An optional int64 id mapping array.
  * \param rhs_mapping An optional int64 id mapping array.
  * \param out_mapping An optional int64 id mapping array.
+ * \param edge_cache An optional tensor of shape (num_edges, *out_feature_shape).
+ *                   If given, the per-edge result of the binary operation is
+ *                   saved in it so that the backward pass does not need to
+ *                   recompute it.
  */
 void BinaryOpReduce(
     const std::string& reducer,
@@ -88,7 +93,8 @@ void BinaryOpReduce(
     runtime::NDArray lhs_data, runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping,
-    runtime::NDArray out_mapping);
+    runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache);
 
 /*!
  * \brief Compute the lhs gradient of BinaryOpReduce
@@ -122,6 +128,7 @@ void BinaryOpReduce(
  *                  tensor depending on the reducer.
  * \param grad_out_data The gradient output tensor.
  * \param grad_lhs_data The gradient lhs tensor.
+ * \param edge_cache An optional tensor saved by BinaryOpReduce.
  */
 void BackwardLhsBinaryOpReduce(
     const std::string& reducer,
@@ -135,7 +142,8 @@ void BackwardLhsBinaryOpReduce(
     runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray grad_out_data,
-    runtime::NDArray grad_lhs_data);
+    runtime::NDArray grad_lhs_data,
+    runtime::NDArray edge_cache);
 
 /*!
  * \brief Compute the rhs gradient of BinaryOpReduce
@@ -169,6 +177,7 @@ void BackwardLhsBinaryOpReduce(
  *                  tensor depending on the reducer.
  * \param grad_out_data The gradient output tensor.
  * \param grad_rhs_data The gradient rhs tensor.
+ * \param edge_cache An optional tensor saved by BinaryOpReduce.
  */
 void BackwardRhsBinaryOpReduce(
     const std::string& reducer,
@@ -182,7 +191,8 @@ void BackwardRhsBinaryOpReduce(
     runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray grad_out_data,
-    runtime::NDArray grad_rhs_data);
+    runtime::NDArray grad_rhs_data,
+    runtime::NDArray edge_cache);
 
 /*!
  * \brief Copy the target data and reduce by graph structure.
@@ -245,6 +255,40 @@ void BackwardCopyReduce(
     runtime::NDArray grad_out_data,
     runtime::NDArray grad_in_data);
 
+/*!
+ * \brief Copy the target data of every relation and reduce them into the
+ *        destination node type of a heterograph in one pass.
+ *
+ * For each node i of type dst_vtype, the operator computes
+ *
+ *   out[i] = Sigma_{r: (*, r, dst_vtype)} Sigma_{j\in Neighbor_r(i)} w[r] * A_r[s(i, j, e)]
+ *
+ * , where A_r is the input feature tensor of relation r and w[r] is the
+ * optional relation weight. The reduction over the neighbors of all
+ * relations uses the same reducer, so this is equivalent to calling
+ * CopyReduce on every relation graph and then combining the results, but
+ * without a kernel launch and a zero-fill per relation. The "mean" reducer
+ * divides the sum by the in-degree of i over all the relations.
+ *
+ * \param reducer The type of the reducer ("sum", "max", "prod", "min", "mean").
+ * \param graph The heterograph object.
+ * \param dst_vtype The destination node type.
+ * \param target The input target (src, edge)
+ * \param in_data The input feature tensors, one per edge type. A none array
+ *                skips the relation. Relations whose destination type is not
+ *                dst_vtype are ignored.
+ * \param etype_weight An optional float tensor of shape (num_etypes,).
+ * \param out_data The output node feature tensor of the destination type.
+ */
+void HeteroCopyReduce(
+    const std::string& reducer,
+    const BaseHeteroGraph* graph,
+    dgl_type_t dst_vtype,
+    binary_op::Target target,
+    const std::vector<runtime::NDArray>& in_data,
+    runtime::NDArray etype_weight,
+    runtime::NDArray out_data);
+
 }  // namespace kernel
 }  // namespace dgl
 
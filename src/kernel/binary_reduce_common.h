@@ -124,11 +124,16 @@ struct SwitchSrcDst<SelectDst> {
 //  - Call: The forward computation given two operand.
 //  - BackwardLhs: Compute lhs gradient.
 //  - BackwardRhs: Compute rhs gradient.
+// and flags telling which operands the gradients read, so that the backward
+// kernels can skip the other reads when the result of the op is cached.
 //////////////////////////////////////////////////////////////////////////
 
 // common binary functors
 template <typename DType>
 struct BinaryAdd {
+  // the operands read by BackwardLhs and BackwardRhs besides the result
+  static constexpr bool kGradLhsReadsLhs = false, kGradLhsReadsRhs = false;
+  static constexpr bool kGradRhsReadsLhs = false, kGradRhsReadsRhs = false;
   static DGLDEVICE DGLINLINE DType Call(DType lhs, DType rhs) {
     return lhs + rhs;
   }
@@ -142,6 +147,9 @@ struct BinaryAdd {
 
 template <typename DType>
 struct BinaryMul {
+  // the operands read by BackwardLhs and BackwardRhs besides the result
+  static constexpr bool kGradLhsReadsLhs = false, kGradLhsReadsRhs = true;
+  static constexpr bool kGradRhsReadsLhs = true, kGradRhsReadsRhs = false;
   static DGLDEVICE DGLINLINE DType Call(DType lhs, DType rhs) {
     return lhs * rhs;
   }
@@ -155,6 +163,9 @@ struct BinaryMul {
 
 template <typename DType>
 struct BinarySub {
+  // the operands read by BackwardLhs and BackwardRhs besides the result
+  static constexpr bool kGradLhsReadsLhs = false, kGradLhsReadsRhs = false;
+  static constexpr bool kGradRhsReadsLhs = false, kGradRhsReadsRhs = false;
   static DGLDEVICE DGLINLINE DType Call(DType lhs, DType rhs) {
     return lhs - rhs;
   }
@@ -168,6 +179,9 @@ struct BinarySub {
 
 template <typename DType>
 struct BinaryDiv {
+  // the operands read by BackwardLhs and BackwardRhs besides the result
+  static constexpr bool kGradLhsReadsLhs = false, kGradLhsReadsRhs = true;
+  static constexpr bool kGradRhsReadsLhs = false, kGradRhsReadsRhs = true;
   static DGLDEVICE DGLINLINE DType Call(DType lhs, DType rhs) {
     return lhs / rhs;
   }
@@ -175,12 +189,16 @@ struct BinaryDiv {
     return static_cast<DType>(1) / rhs;
   }
   static DGLDEVICE DGLINLINE DType BackwardRhs(DType lhs, DType rhs, DType out) {
-    return -lhs / (rhs * rhs);
+    // out is lhs / rhs
+    return -out / rhs;
   }
 };
 
 template <typename DType>
 struct BinaryUseLhs {
+  // the operands read by BackwardLhs and BackwardRhs besides the result
+  static constexpr bool kGradLhsReadsLhs = false, kGradLhsReadsRhs = false;
+  static constexpr bool kGradRhsReadsLhs = false, kGradRhsReadsRhs = false;
   static DGLDEVICE DGLINLINE DType Call(DType lhs, DType rhs) {
     return lhs;
   }
@@ -63,7 +63,8 @@ void BinaryReduceImpl(
     runtime::NDArray lhs_data, runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping,
-    runtime::NDArray out_mapping) {
+    runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache) {
   using runtime::NDArray;
   using minigun::Csr;
   // device
@@ -95,6 +96,9 @@ void BinaryReduceImpl(
         auto gdata = AllocGData<XPU, Idx, DType, Reducer>(
             rtcfg.ctx, x_len, lhs_mapping, rhs_mapping,
             lhs_data, rhs_data, out_mapping, out_data);
+        if (!utils::IsNoneArray(edge_cache)) {
+          gdata.edge_cache = static_cast<DType*>(edge_cache->data);
+        }
         OP_TARGET_SWITCH(op, lhs, rhs, DType, BinaryOp, LeftTarget, RightTarget, {
           CallBinaryReduce<XPU, Idx, DType, LeftTarget,
             RightTarget, BinaryOp, Reducer>(rtcfg, graph, &gdata);
@@ -156,7 +160,8 @@ void BackwardBinaryReduceImpl(
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping,
     runtime::NDArray lhs_data, runtime::NDArray rhs_data, runtime::NDArray out_data,
     runtime::NDArray grad_out_data,
-    runtime::NDArray grad_lhs_data, runtime::NDArray grad_rhs_data) {
+    runtime::NDArray grad_lhs_data, runtime::NDArray grad_rhs_data,
+    runtime::NDArray edge_cache) {
   using runtime::NDArray;
   using minigun::Csr;
 #ifdef __CUDACC__
@@ -192,6 +197,9 @@ void BackwardBinaryReduceImpl(
           rtcfg.ctx, x_len, lhs_mapping, rhs_mapping, out_mapping,
           lhs_data, rhs_data, out_data, grad_out_data,
           grad_lhs_data, grad_rhs_data);
+      if (!utils::IsNoneArray(edge_cache)) {
+        gdata.edge_cache = static_cast<DType*>(edge_cache->data);
+      }
       BACKWARD_MODE_SWITCH(req_lhs, req_rhs, Mode, {
         REDUCER_SWITCH(reducer, XPU, DType, Reducer, {
           OP_TARGET_SWITCH(op, lhs, rhs, DType, BinaryOp, LeftTarget, RightTarget, {
@@ -258,7 +266,8 @@ void BinaryReduceBcastImpl(
     runtime::NDArray out_data,
     runtime::NDArray lhs_mapping,
     runtime::NDArray rhs_mapping,
-    runtime::NDArray out_mapping) {
+    runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache) {
   using runtime::NDArray;
   using minigun::Csr;
 #ifdef __CUDACC__
@@ -291,6 +300,9 @@ void BinaryReduceBcastImpl(
           auto gdata = AllocBcastGData<XPU, NDim, Idx, DType, Reducer>(
               rtcfg.ctx, info, lhs_mapping, rhs_mapping,
               lhs_data, rhs_data, out_mapping, out_data);
+          if (!utils::IsNoneArray(edge_cache)) {
+            gdata.edge_cache = static_cast<DType*>(edge_cache->data);
+          }
           OP_TARGET_SWITCH(op, lhs, rhs, DType, BinaryOp, LeftTarget, RightTarget, {
             CallBinaryReduceBcast<XPU, NDim, Idx, DType, LeftTarget,
               RightTarget, BinaryOp, Reducer>(rtcfg, graph, &gdata);
@@ -363,7 +375,8 @@ void BackwardBinaryReduceBcastImpl(
     binary_op::Target lhs_tgt, binary_op::Target rhs_tgt,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping,
     runtime::NDArray lhs, runtime::NDArray rhs, runtime::NDArray out, runtime::NDArray grad_out,
-    runtime::NDArray grad_lhs, runtime::NDArray grad_rhs) {
+    runtime::NDArray grad_lhs, runtime::NDArray grad_rhs,
+    runtime::NDArray edge_cache) {
   using runtime::NDArray;
   using minigun::Csr;
 #ifdef __CUDACC__
@@ -399,6 +412,9 @@ void BackwardBinaryReduceBcastImpl(
             lhs_mapping, rhs_mapping, out_mapping,
             lhs, rhs, out, grad_out,
             grad_lhs, grad_rhs);
+        if (!utils::IsNoneArray(edge_cache)) {
+          gdata.edge_cache = static_cast<DType*>(edge_cache->data);
+        }
         BACKWARD_MODE_SWITCH(req_lhs, req_rhs, Mode, {
           REDUCER_SWITCH(reducer, XPU, DType, Reducer, {
             OP_TARGET_SWITCH(op, lhs_tgt, rhs_tgt, DType, BinaryOp, LeftTarget, RightTarget, {
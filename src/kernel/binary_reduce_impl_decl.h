@@ -7,8 +7,10 @@
 #define DGL_KERNEL_BINARY_REDUCE_IMPL_DECL_H_
 
 #include <dgl/runtime/ndarray.h>
+#include <dgl/array.h>
 
 #include <string>
+#include <vector>
 
 #include "./binary_reduce_common.h"
 
@@ -23,6 +25,7 @@ namespace dgl {
 
 // forward declaration
 class ImmutableGraph;
+class BaseHeteroGraph;
 
 namespace kernel {
 
@@ -48,6 +51,10 @@ struct GData {
   Idx *lhs_mapping{nullptr}, *rhs_mapping{nullptr};
   // output id mapping
   Idx *out_mapping{nullptr};
+  // optional per-edge cache of the binary op result (see BinaryOpReduce)
+  DType *edge_cache{nullptr};
+  // edge ids of the csr used to index the edge cache
+  Idx *cache_mapping{nullptr};
 };
 
 /*!
@@ -102,6 +109,7 @@ void CallBinaryReduce(
  * \param lhs_mapping An optional int64 id mapping array.
  * \param rhs_mapping An optional int64 id mapping array.
  * \param out_mapping An optional int64 id mapping array.
+ * \param edge_cache An optional tensor to save the per-edge binary op result.
  */
 template <int XPU>
 void BinaryReduceImpl(
@@ -110,7 +118,8 @@ void BinaryReduceImpl(
     const ImmutableGraph* graph,
     binary_op::Target lhs, binary_op::Target rhs,
     runtime::NDArray lhs_data, runtime::NDArray rhs_data, runtime::NDArray out_data,
-    runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping);
+    runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache);
 
 ///////////////////////////////////////////////////////////////////////////////
 // BackwardBinaryReduce declarations
@@ -132,6 +141,10 @@ struct BackwardGData {
   Idx *lhs_mapping{nullptr}, *rhs_mapping{nullptr};
   // output id mapping
   Idx *out_mapping{nullptr};
+  // optional per-edge cache of the binary op result (see BinaryOpReduce)
+  DType *edge_cache{nullptr};
+  // edge ids of the csr used to index the edge cache
+  Idx *cache_mapping{nullptr};
 };
 
 /*!
@@ -191,6 +204,9 @@ void CallBackwardBinaryReduce(
  *                  tensor depending on the reducer.
  * \param grad_out_data The gradient output tensor.
  * \param grad_lhs_data The gradient lhs tensor.
+ * \param grad_rhs_data The gradient rhs tensor.
+ * \param edge_cache An optional tensor of the per-edge binary op result saved
+ *                   by the forward pass. If given, the result is not recomputed.
  */
 template <int XPU>
 void BackwardBinaryReduceImpl(
@@ -201,7 +217,8 @@ void BackwardBinaryReduceImpl(
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping,
     runtime::NDArray lhs_data, runtime::NDArray rhs_data, runtime::NDArray out_data,
     runtime::NDArray grad_out_data,
-    runtime::NDArray grad_lhs_data, runtime::NDArray grad_rhs_data);
+    runtime::NDArray grad_lhs_data, runtime::NDArray grad_rhs_data,
+    runtime::NDArray edge_cache);
 
 ///////////////////////////////////////////////////////////////////////////////
 // BinaryReduce with broadcasting declarations
@@ -235,6 +252,10 @@ struct BcastGData {
   DType *out_data{nullptr};
   // output id mapping
   Idx *out_mapping{nullptr};
+  // optional per-edge cache of the binary op result (see BinaryOpReduce)
+  DType *edge_cache{nullptr};
+  // edge ids of the csr used to index the edge cache
+  Idx *cache_mapping{nullptr};
 };
 
 /*!
@@ -290,6 +311,7 @@ void CallBinaryReduceBcast(
  * \param lhs_mapping An optional int64 id mapping array.
  * \param rhs_mapping An optional int64 id mapping array.
  * \param out_mapping An optional int64 id mapping array.
+ * \param edge_cache An optional tensor to save the per-edge binary op result.
  */
 template <int XPU>
 void BinaryReduceBcastImpl(
@@ -301,7 +323,8 @@ void BinaryReduceBcastImpl(
     runtime::NDArray lhs_data, runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping,
-    runtime::NDArray out_mapping);
+    runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache);
 
 ///////////////////////////////////////////////////////////////////////////////
 // BackwardBinaryReduce with broadcasting declarations
@@ -335,6 +358,10 @@ struct BackwardBcastGData {
   DType *grad_out_data{nullptr};
   // output data
   DType *grad_lhs_data{nullptr}, *grad_rhs_data{nullptr};
+  // optional per-edge cache of the binary op result (see BinaryOpReduce)
+  DType *edge_cache{nullptr};
+  // edge ids of the csr used to index the edge cache
+  Idx *cache_mapping{nullptr};
 };
 
 /*!
@@ -393,6 +420,9 @@ void CallBackwardBinaryReduceBcast(
  *                  tensor depending on the reducer.
  * \param grad_out_data The gradient output tensor.
  * \param grad_lhs_data The gradient lhs tensor.
+ * \param grad_rhs_data The gradient rhs tensor.
+ * \param edge_cache An optional tensor of the per-edge binary op result saved
+ *                   by the forward pass. If given, the result is not recomputed.
  */
 template <int XPU>
 void BackwardBinaryReduceBcastImpl(
@@ -404,7 +434,41 @@ void BackwardBinaryReduceBcastImpl(
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping,
     runtime::NDArray lhs_data, runtime::NDArray rhs_data, runtime::NDArray out_data,
     runtime::NDArray grad_out_data,
-    runtime::NDArray grad_lhs_data, runtime::NDArray grad_rhs_data);
+    runtime::NDArray grad_lhs_data, runtime::NDArray grad_rhs_data,
+    runtime::NDArray edge_cache);
+
+///////////////////////////////////////////////////////////////////////////////
+// HeteroCopyReduce declarations
+///////////////////////////////////////////////////////////////////////////////
+
+/*!
+ * \brief Template declaration for the multi-relation copy-reduce operator.
+ *
+ * Unlike BinaryReduceImpl, this operator is not driven by minigun. Each
+ * destination row is owned by exactly one thread which walks the in-edge CSR
+ * of every relation pointing to the destination node type, so no atomic
+ * operation is needed and the output is written exactly once.
+ *
+ * \tparam XPU the device flag
+ * \param reducer The type of the reducer ("sum", "max", "min", "prod", "mean").
+ * \param graph The heterograph object.
+ * \param dst_vtype The destination node type.
+ * \param target The input target (src, edge)
+ * \param in_data The input feature tensor of each edge type. A none array
+ *                skips the relation.
+ * \param etype_weight An optional float tensor of shape (num_etypes,). The
+ *                     message of relation r is scaled by etype_weight[r].
+ * \param out_data The output node feature tensor of the destination type.
+ */
+template <int XPU>
+void HeteroCopyReduceImpl(
+    const std::string& reducer,
+    const BaseHeteroGraph* graph,
+    dgl_type_t dst_vtype,
+    binary_op::Target target,
+    const std::vector<runtime::NDArray>& in_data,
+    runtime::NDArray etype_weight,
+    runtime::NDArray out_data);
 
 }  // namespace kernel
 }  // namespace dgl
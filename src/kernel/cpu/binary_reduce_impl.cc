@@ -18,7 +18,8 @@ template void BinaryReduceImpl<kDLCPU>(
     runtime::NDArray lhs_data, runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping,
-    runtime::NDArray out_mapping);
+    runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache);
 
 template void BinaryReduceBcastImpl<kDLCPU>(
     const BcastInfo& info,
@@ -29,7 +30,8 @@ template void BinaryReduceBcastImpl<kDLCPU>(
     runtime::NDArray lhs_data, runtime::NDArray rhs_data,
     runtime::NDArray out_data,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping,
-    runtime::NDArray out_mapping);
+    runtime::NDArray out_mapping,
+    runtime::NDArray edge_cache);
 
 template void BackwardBinaryReduceImpl<kDLCPU>(
     const std::string& reducer,
@@ -39,7 +41,8 @@ template void BackwardBinaryReduceImpl<kDLCPU>(
     NDArray lhs_mapping, NDArray rhs_mapping, NDArray out_mapping,
     NDArray lhs_data, NDArray rhs_data, NDArray out_data,
     NDArray grad_out_data,
-    NDArray grad_lhs_data, NDArray grad_rhs_data);
+    NDArray grad_lhs_data, NDArray grad_rhs_data,
+    NDArray edge_cache);
 
 template void BackwardBinaryReduceBcastImpl<kDLCPU>(
     const BcastInfo& info,
@@ -49,7 +52,8 @@ template void BackwardBinaryReduceBcastImpl<kDLCPU>(
     binary_op::Target lhs_tgt, binary_op::Target rhs_tgt,
     runtime::NDArray lhs_mapping, runtime::NDArray rhs_mapping, runtime::NDArray out_mapping,
     runtime::NDArray lhs, runtime::NDArray rhs, runtime::NDArray out, runtime::NDArray grad_out,
-    runtime::NDArray grad_lhs, runtime::NDArray grad_rhs);
+    runtime::NDArray grad_lhs, runtime::NDArray grad_rhs,
+    runtime::NDArray edge_cache);
 
 }  // namespace kernel
 }  // namespace dgl
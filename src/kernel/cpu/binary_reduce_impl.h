@@ -44,10 +44,19 @@ struct BinaryReduce {
     DType* lhsoff = gdata->lhs_data + lid * D;
     DType* rhsoff = gdata->rhs_data + rid * D;
     DType* outoff = gdata->out_data + oid * D;
+    Idx cid = eid;
+    if (gdata->cache_mapping) {
+      cid = Functors::GetId(cid, gdata->cache_mapping);
+    }
+    DType* cacheoff = gdata->edge_cache ?
+      gdata->edge_cache + cid * D : nullptr;
     for (int64_t tx = 0; tx < D; ++tx) {
       DType lhs = Functors::Read(lhsoff + tx);
       DType rhs = Functors::Read(rhsoff + tx);
       DType out = Functors::Op(lhs, rhs);
+      if (cacheoff) {
+        cacheoff[tx] = out;
+      }
       Functors::Write(outoff + tx, out);
     }
   }
@@ -95,6 +104,12 @@ struct BinaryReduceBcast {
     DType* lhsoff = gdata->lhs_data + lid * gdata->lhs_len;
     DType* rhsoff = gdata->rhs_data + rid * gdata->rhs_len;
     DType* outoff = gdata->out_data + oid * gdata->out_len;
+    Idx cid = eid;
+    if (gdata->cache_mapping) {
+      cid = Functors::GetId(cid, gdata->cache_mapping);
+    }
+    DType* cacheoff = gdata->edge_cache ?
+      gdata->edge_cache + cid * gdata->out_len : nullptr;
     int64_t tmp[NDim];  // store unraveled idx.
     for (int64_t tx = 0; tx < gdata->out_len; ++tx) {
       Unravel(tx, gdata->ndim, gdata->out_shape, gdata->out_stride, tmp);
@@ -103,6 +118,9 @@ struct BinaryReduceBcast {
       DType rhs = Functors::Read(rhsoff +
           Ravel(tmp, gdata->ndim, gdata->rhs_shape, gdata->rhs_stride));
       DType out = Functors::Op(lhs, rhs);
+      if (cacheoff) {
+        cacheoff[tx] = out;
+      }
       Functors::Write(outoff + tx, out);
     }
   }
@@ -161,14 +179,17 @@ void CallBinaryReduce(const minigun::advance::RuntimeConfig& rtcfg,
   // replace the mapping by the edge ids in the csr graph so that the edge
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
+  }
+  if (gdata->edge_cache != nullptr) {
+    gdata->cache_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cpu::AdvanceConfig, GData<Idx, DType>, UDF>(
@@ -194,14 +215,17 @@ void CallBinaryReduceBcast(
   // replace the mapping by the edge ids in the csr graph so that the edge
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
+  }
+  if (gdata->edge_cache != nullptr) {
+    gdata->cache_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cpu::AdvanceConfig,
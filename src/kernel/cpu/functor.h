@@ -22,6 +22,8 @@ struct ReduceSum<kDLCPU, DType> {
 #pragma omp atomic
     *addr += val;
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = false;
   static DType BackwardCall(DType val, DType accum) {
     return 1;
   }
@@ -33,6 +35,8 @@ struct ReduceMax<kDLCPU, DType> {
 #pragma omp critical
     *addr = std::max(*addr, val);
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = true;
   static DType BackwardCall(DType val, DType accum) {
     return static_cast<DType>(val == accum);
   }
@@ -44,6 +48,8 @@ struct ReduceMin<kDLCPU, DType> {
 #pragma omp critical
     *addr = std::min(*addr, val);
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = true;
   static DType BackwardCall(DType val, DType accum) {
     return static_cast<DType>(val == accum);
   }
@@ -55,6 +61,8 @@ struct ReduceProd<kDLCPU, DType> {
 #pragma omp atomic
     *addr *= val;
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = true;
   static DType BackwardCall(DType val, DType accum) {
     return accum / val;
   }
@@ -65,6 +73,8 @@ struct ReduceNone<kDLCPU, DType> {
   static void Call(DType* addr, DType val) {
     *addr = val;
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = false;
   static DType BackwardCall(DType val, DType accum) {
     return 1;
   }
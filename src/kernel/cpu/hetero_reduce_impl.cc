@@ -0,0 +1,175 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file kernel/cpu/hetero_reduce_impl.cc
+ * \brief Multi-relation copy reduce implementation on CPU.
+ */
+#include <dmlc/omp.h>
+#include <dgl/base_heterograph.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../binary_reduce_impl_decl.h"
+#include "../common.h"
+#include "../utils.h"
+
+using dgl::runtime::NDArray;
+
+namespace dgl {
+namespace kernel {
+namespace {
+
+// Non-atomic reducers. The destination row is owned by a single thread,
+// so the atomic/critical sections of the minigun reducers are not needed.
+template <typename Reducer>
+struct OwnerReduce { };
+
+template <typename DType>
+struct OwnerReduce<ReduceSum<kDLCPU, DType>> {
+  static inline void Call(DType* addr, DType val) {
+    *addr += val;
+  }
+};
+
+template <typename DType>
+struct OwnerReduce<ReduceMax<kDLCPU, DType>> {
+  static inline void Call(DType* addr, DType val) {
+    *addr = std::max(*addr, val);
+  }
+};
+
+template <typename DType>
+struct OwnerReduce<ReduceMin<kDLCPU, DType>> {
+  static inline void Call(DType* addr, DType val) {
+    *addr = std::min(*addr, val);
+  }
+};
+
+template <typename DType>
+struct OwnerReduce<ReduceProd<kDLCPU, DType>> {
+  static inline void Call(DType* addr, DType val) {
+    *addr *= val;
+  }
+};
+
+// REDUCER_SWITCH without the "none" reducer, which HeteroCopyReduce rejects.
+#define OWNER_REDUCER_SWITCH(val, DType, RedType, ...)      \
+  if (val == binary_op::kReduceSum                         \
+      || val == binary_op::kReduceMean) {                  \
+    typedef ReduceSum<kDLCPU, DType> RedType;              \
+    {__VA_ARGS__}                                          \
+  } else if (val == binary_op::kReduceMax) {               \
+    typedef ReduceMax<kDLCPU, DType> RedType;              \
+    {__VA_ARGS__}                                          \
+  } else if (val == binary_op::kReduceMin) {               \
+    typedef ReduceMin<kDLCPU, DType> RedType;              \
+    {__VA_ARGS__}                                          \
+  } else if (val == binary_op::kReduceProd) {              \
+    typedef ReduceProd<kDLCPU, DType> RedType;             \
+    {__VA_ARGS__}                                          \
+  } else {                                                 \
+    LOG(FATAL) << "Unsupported reducer: " << val;          \
+  }
+
+// In-edge CSR and input feature of one relation.
+template <typename Idx, typename DType>
+struct RelationData {
+  const Idx* indptr{nullptr};
+  const Idx* indices{nullptr};
+  const Idx* edge_ids{nullptr};
+  const DType* in_data{nullptr};
+  DType weight{1};
+};
+
+// If mean is true, the sums are divided by the number of in-edges of the row
+// over all the relations.
+template <typename Idx, typename DType, typename Reducer>
+void HeteroCopyReduceRows(
+    const std::vector<RelationData<Idx, DType>>& rels,
+    binary_op::Target target, bool mean,
+    int64_t num_rows, int64_t x_len,
+    DType* out_data) {
+#pragma omp parallel for
+  for (int64_t dst = 0; dst < num_rows; ++dst) {
+    DType* outoff = out_data + dst * x_len;
+    std::fill(outoff, outoff + x_len, Zero<Reducer>::value);
+    int64_t degree = 0;
+    for (const auto& rel : rels) {
+      degree += rel.indptr[dst + 1] - rel.indptr[dst];
+      for (Idx j = rel.indptr[dst]; j < rel.indptr[dst + 1]; ++j) {
+        const Idx row = (target == binary_op::kSrc)? rel.indices[j] : rel.edge_ids[j];
+        const DType* inoff = rel.in_data + row * x_len;
+        for (int64_t tx = 0; tx < x_len; ++tx) {
+          OwnerReduce<Reducer>::Call(outoff + tx, rel.weight * inoff[tx]);
+        }
+      }
+    }
+    if (mean && degree > 0) {
+      for (int64_t tx = 0; tx < x_len; ++tx) {
+        outoff[tx] /= static_cast<DType>(degree);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <int XPU>
+void HeteroCopyReduceImpl(
+    const std::string& reducer,
+    const BaseHeteroGraph* graph,
+    dgl_type_t dst_vtype,
+    binary_op::Target target,
+    const std::vector<NDArray>& in_data,
+    NDArray etype_weight,
+    NDArray out_data) {
+  const bool mean = (reducer == binary_op::kReduceMean);
+  const int64_t x_len = utils::ComputeXLength(out_data);
+  const int64_t num_rows = out_data->shape[0];
+  const DLDataType& dtype = out_data->dtype;
+  const auto bits = graph->NumBits();
+  const auto meta_graph = graph->meta_graph();
+  // Keep the in-CSR arrays alive while the raw pointers are in use.
+  std::vector<std::vector<IdArray>> adjs;
+  adjs.reserve(graph->NumEdgeTypes());
+  DGL_DTYPE_SWITCH(dtype, DType, {
+    DGL_IDX_TYPE_SWITCH(bits, Idx, {
+      std::vector<RelationData<Idx, DType>> rels;
+      for (dgl_type_t etype = 0; etype < graph->NumEdgeTypes(); ++etype) {
+        if (utils::IsNoneArray(in_data[etype])
+            || meta_graph->FindEdge(etype).second != dst_vtype) {
+          continue;
+        }
+        // GetAdj(transpose=false) returns the in-edge CSR: row for dst, col for src.
+        adjs.push_back(graph->GetAdj(etype, false, "csr"));
+        const auto& adj = adjs.back();
+        RelationData<Idx, DType> rel;
+        rel.indptr = static_cast<Idx*>(adj[0]->data);
+        rel.indices = static_cast<Idx*>(adj[1]->data);
+        rel.edge_ids = static_cast<Idx*>(adj[2]->data);
+        rel.in_data = static_cast<DType*>(in_data[etype]->data);
+        if (!utils::IsNoneArray(etype_weight)) {
+          rel.weight = static_cast<DType*>(etype_weight->data)[etype];
+        }
+        rels.push_back(rel);
+      }
+      OWNER_REDUCER_SWITCH(reducer, DType, Reducer, {
+        HeteroCopyReduceRows<Idx, DType, Reducer>(
+            rels, target, mean, num_rows, x_len, static_cast<DType*>(out_data->data));
+      });
+    });
+  });
+}
+
+template void HeteroCopyReduceImpl<kDLCPU>(
+    const std::string& reducer,
+    const BaseHeteroGraph* graph,
+    dgl_type_t dst_vtype,
+    binary_op::Target target,
+    const std::vector<NDArray>& in_data,
+    NDArray etype_weight,
+    NDArray out_data);
+
+}  // namespace kernel
+}  // namespace dgl
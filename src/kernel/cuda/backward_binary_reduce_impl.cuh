@@ -20,6 +20,15 @@ namespace cuda {
 // Minigun UDF to compute backward binary reduce.
 template <int Mode, typename Idx, typename DType, typename Functors>
 struct BackwardBinaryReduce {
+  // With the result of the op cached, lhs (rhs) is only read if the
+  // requested gradients depend on it. out is only read by the reducers
+  // whose gradient depends on it.
+  static constexpr bool kGradLhs = Mode == binary_op::kGradLhs || Mode == binary_op::kGradBoth;
+  static constexpr bool kGradRhs = Mode == binary_op::kGradRhs || Mode == binary_op::kGradBoth;
+  static constexpr bool kCachedReadsLhs = (kGradLhs && Functors::kGradLhsReadsLhs)
+    || (kGradRhs && Functors::kGradRhsReadsLhs);
+  static constexpr bool kCachedReadsRhs = (kGradLhs && Functors::kGradLhsReadsRhs)
+    || (kGradRhs && Functors::kGradRhsReadsRhs);
   static __device__ __forceinline__ bool CondEdge(
       Idx src, Idx dst, Idx eid, BackwardGData<Idx, DType>* gdata) {
     return true;
@@ -47,18 +56,37 @@ struct BackwardBinaryReduce {
     DType* gradlhsoff = gdata->grad_lhs_data + lid * D;
     DType* gradrhsoff = gdata->grad_rhs_data + rid * D;
     DType* gradoutoff = gdata->grad_out_data + oid * D;
+    Idx cid = eid;
+    if (gdata->cache_mapping) {
+      cid = Functors::GetId(cid, gdata->cache_mapping);
+    }
+    const DType* cacheoff = gdata->edge_cache ?
+      gdata->edge_cache + cid * D : nullptr;
     while (tx < D) {
-      DType lhs = Functors::Read(lhsoff + tx);
-      DType rhs = Functors::Read(rhsoff + tx);
-      DType out = Functors::Read(outoff + tx);
+      DType lhs = 0, rhs = 0, e = 0, out = 0;
+      if (cacheoff) {
+        e = cacheoff[tx];
+        if (kCachedReadsLhs) {
+          lhs = Functors::Read(lhsoff + tx);
+        }
+        if (kCachedReadsRhs) {
+          rhs = Functors::Read(rhsoff + tx);
+        }
+      } else {
+        lhs = Functors::Read(lhsoff + tx);
+        rhs = Functors::Read(rhsoff + tx);
+        e = Functors::Op(lhs, rhs);
+      }
+      if (Functors::kGradReadsOut) {
+        out = Functors::Read(outoff + tx);
+      }
       DType grad_out = Functors::Read(gradoutoff + tx);
-      DType e = Functors::Op(lhs, rhs);
       DType grad_e = grad_out * Functors::BackwardWrite(e, out);
-      if (Mode == binary_op::kGradLhs || Mode == binary_op::kGradBoth) {
+      if (kGradLhs) {
         DType grad_lhs = grad_e * Functors::BackwardOpLhs(lhs, rhs, e);
         AtomicAdd(gradlhsoff + tx, grad_lhs);
       }
-      if (Mode == binary_op::kGradRhs || Mode == binary_op::kGradBoth) {
+      if (kGradRhs) {
         DType grad_rhs = grad_e * Functors::BackwardOpRhs(lhs, rhs, e);
         AtomicAdd(gradrhsoff + tx, grad_rhs);
       }
@@ -70,6 +98,15 @@ struct BackwardBinaryReduce {
 // Minigun UDF to compute backward binary reduce with broadcasting.
 template <int Mode, int NDim, typename Idx, typename DType, typename Functors>
 struct BackwardBinaryReduceBcast {
+  // With the result of the op cached, lhs (rhs) is only read if the
+  // requested gradients depend on it. out is only read by the reducers
+  // whose gradient depends on it.
+  static constexpr bool kGradLhs = Mode == binary_op::kGradLhs || Mode == binary_op::kGradBoth;
+  static constexpr bool kGradRhs = Mode == binary_op::kGradRhs || Mode == binary_op::kGradBoth;
+  static constexpr bool kCachedReadsLhs = (kGradLhs && Functors::kGradLhsReadsLhs)
+    || (kGradRhs && Functors::kGradRhsReadsLhs);
+  static constexpr bool kCachedReadsRhs = (kGradLhs && Functors::kGradLhsReadsRhs)
+    || (kGradRhs && Functors::kGradRhsReadsRhs);
   static __device__ __forceinline__ bool CondEdge(
       Idx src, Idx dst, Idx eid, BackwardBcastGData<NDim, Idx, DType>* gdata) {
     return true;
@@ -96,22 +133,35 @@ struct BackwardBinaryReduceBcast {
     DType* gradlhsoff = gdata->grad_lhs_data + lid * gdata->out_len;
     DType* gradrhsoff = gdata->grad_rhs_data + rid * gdata->out_len;
     DType* gradoutoff = gdata->grad_out_data + oid * gdata->out_len;
+    Idx cid = eid;
+    if (gdata->cache_mapping) {
+      cid = Functors::GetId(cid, gdata->cache_mapping);
+    }
+    const DType* cacheoff = gdata->edge_cache ?
+      gdata->edge_cache + cid * gdata->out_len : nullptr;
     int64_t tmp[NDim];  // store unraveled idx.
     while (tx < gdata->out_len) {
       Unravel(tx, gdata->ndim, gdata->out_shape, gdata->out_stride, tmp);
-      DType lhs = Functors::Read(lhsoff +
-          Ravel(tmp, gdata->ndim, gdata->lhs_shape, gdata->lhs_stride));
-      DType rhs = Functors::Read(rhsoff +
-          Ravel(tmp, gdata->ndim, gdata->rhs_shape, gdata->rhs_stride));
-      DType out = Functors::Read(outoff + tx);
+      DType lhs = 0, rhs = 0, e = 0, out = 0;
+      if (!cacheoff || kCachedReadsLhs) {
+        lhs = Functors::Read(lhsoff +
+            Ravel(tmp, gdata->ndim, gdata->lhs_shape, gdata->lhs_stride));
+      }
+      if (!cacheoff || kCachedReadsRhs) {
+        rhs = Functors::Read(rhsoff +
+            Ravel(tmp, gdata->ndim, gdata->rhs_shape, gdata->rhs_stride));
+      }
+      e = cacheoff ? cacheoff[tx] : Functors::Op(lhs, rhs);
+      if (Functors::kGradReadsOut) {
+        out = Functors::Read(outoff + tx);
+      }
       DType grad_out = Functors::Read(gradoutoff + tx);
-      DType e = Functors::Op(lhs, rhs);
       DType grad_e = grad_out * Functors::BackwardWrite(e, out);
-      if (Mode == binary_op::kGradLhs || Mode == binary_op::kGradBoth) {
+      if (kGradLhs) {
         DType grad_lhs = grad_e * Functors::BackwardOpLhs(lhs, rhs, e);
         AtomicAdd(gradlhsoff + tx, grad_lhs);
       }
-      if (Mode == binary_op::kGradRhs || Mode == binary_op::kGradBoth) {
+      if (kGradRhs) {
         DType grad_rhs = grad_e * Functors::BackwardOpRhs(lhs, rhs, e);
         AtomicAdd(gradrhsoff + tx, grad_rhs);
       }
@@ -125,6 +175,11 @@ template <typename Idx, typename DType,
           typename LeftSelector, typename RightSelector,
           typename BinaryOp, typename Reducer>
 struct BackwardFunctorsTempl {
+  static constexpr bool kGradLhsReadsLhs = BinaryOp::kGradLhsReadsLhs;
+  static constexpr bool kGradLhsReadsRhs = BinaryOp::kGradLhsReadsRhs;
+  static constexpr bool kGradRhsReadsLhs = BinaryOp::kGradRhsReadsLhs;
+  static constexpr bool kGradRhsReadsRhs = BinaryOp::kGradRhsReadsRhs;
+  static constexpr bool kGradReadsOut = Reducer::kBackwardReadsAccum;
   static __device__ __forceinline__ Idx SelectOut(
       Idx src, Idx edge, Idx dst) {
     typedef typename OutSelector<Reducer>::Type OutTarget;
@@ -189,15 +244,18 @@ void CallBackwardBinaryReduce(
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge
       && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge
       && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
+  }
+  if (gdata->edge_cache != nullptr) {
+    gdata->cache_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cuda::AdvanceConfig, BackwardGData<Idx, DType>, UDF>(
@@ -239,15 +297,18 @@ void CallBackwardBinaryReduceBcast(
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge
       && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge
       && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
+  }
+  if (gdata->edge_cache != nullptr) {
+    gdata->cache_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cuda::AdvanceConfig,
@@ -44,10 +44,19 @@ struct BinaryReduce {
     DType* lhsoff = gdata->lhs_data + lid * D;
     DType* rhsoff = gdata->rhs_data + rid * D;
     DType* outoff = gdata->out_data + oid * D;
+    Idx cid = eid;
+    if (gdata->cache_mapping) {
+      cid = Functors::GetId(cid, gdata->cache_mapping);
+    }
+    DType* cacheoff = gdata->edge_cache ?
+      gdata->edge_cache + cid * D : nullptr;
     while (tx < D) {
       DType lhs = Functors::Read(lhsoff + tx);
       DType rhs = Functors::Read(rhsoff + tx);
       DType out = Functors::Op(lhs, rhs);
+      if (cacheoff) {
+        cacheoff[tx] = out;
+      }
       Functors::Write(outoff + tx, out);
       tx += stride_x;
     }
@@ -98,6 +107,12 @@ struct BinaryReduceBcast {
     DType* lhsoff = gdata->lhs_data + lid * gdata->lhs_len;
     DType* rhsoff = gdata->rhs_data + rid * gdata->rhs_len;
     DType* outoff = gdata->out_data + oid * gdata->out_len;
+    Idx cid = eid;
+    if (gdata->cache_mapping) {
+      cid = Functors::GetId(cid, gdata->cache_mapping);
+    }
+    DType* cacheoff = gdata->edge_cache ?
+      gdata->edge_cache + cid * gdata->out_len : nullptr;
     int64_t tmp[NDim];  // store unraveled idx.
     while (tx < gdata->out_len) {
       Unravel(tx, gdata->ndim, gdata->out_shape, gdata->out_stride, tmp);
@@ -106,6 +121,9 @@ struct BinaryReduceBcast {
       DType rhs = Functors::Read(rhsoff +
           Ravel(tmp, gdata->ndim, gdata->rhs_shape, gdata->rhs_stride));
       DType out = Functors::Op(lhs, rhs);
+      if (cacheoff) {
+        cacheoff[tx] = out;
+      }
       Functors::Write(outoff + tx, out);
       tx += stride_x;
     }
@@ -164,14 +182,17 @@ void CallBinaryReduce(const minigun::advance::RuntimeConfig& rtcfg,
   // replace the mapping by the edge ids in the csr graph so that the edge
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
+  }
+  if (gdata->edge_cache != nullptr) {
+    gdata->cache_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cuda::AdvanceConfig, GData<Idx, DType>, UDF>(
@@ -197,14 +218,17 @@ void CallBinaryReduceBcast(
   // replace the mapping by the edge ids in the csr graph so that the edge
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
+  }
+  if (gdata->edge_cache != nullptr) {
+    gdata->cache_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cuda::AdvanceConfig,
@@ -172,14 +172,14 @@ void FallbackCallBinaryReduce(
   // replace the mapping by the edge ids in the csr graph so that the edge
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(outcsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(outcsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cuda::AdvanceConfig, GData<Idx, DType>, UDF>(
@@ -214,15 +214,15 @@ void FallbackCallBackwardBinaryReduce(
   // data is correctly read/written.
   if (LeftSelector::target == binary_op::kEdge
       && gdata->lhs_mapping == nullptr) {
-    gdata->lhs_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->lhs_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   if (RightSelector::target == binary_op::kEdge
       && gdata->rhs_mapping == nullptr) {
-    gdata->rhs_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->rhs_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   if (OutSelector<Reducer>::Type::target == binary_op::kEdge
       && gdata->out_mapping == nullptr) {
-    gdata->out_mapping = static_cast<Idx*>(incsr->edge_ids()->data);
+    gdata->out_mapping = utils::EdgeIdMapping<Idx>(incsr->edge_ids());
   }
   // TODO(minjie): allocator
   minigun::advance::Advance<XPU, Idx, cuda::AdvanceConfig, BackwardGData<Idx, DType>, UDF>(
@@ -33,6 +33,8 @@ struct ReduceSum<kDLGPU, DType> {
   static __device__ __forceinline__ void Call(DType* addr, DType val) {
     cuda::AtomicAdd(addr, val);
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = false;
   static __device__ __forceinline__ DType BackwardCall(DType val, DType accum) {
     return 1;
   }
@@ -43,6 +45,8 @@ struct ReduceMax<kDLGPU, DType> {
   static __device__ __forceinline__ void Call(DType* addr, DType val) {
     cuda::AtomicMax(addr, val);
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = true;
   static __device__ __forceinline__ DType BackwardCall(DType val, DType accum) {
     return static_cast<DType>(val == accum);
   }
@@ -53,6 +57,8 @@ struct ReduceMin<kDLGPU, DType> {
   static __device__ __forceinline__ void Call(DType* addr, DType val) {
     cuda::AtomicMin(addr, val);
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = true;
   static __device__ __forceinline__ DType BackwardCall(DType val, DType accum) {
     return static_cast<DType>(val == accum);
   }
@@ -63,6 +69,8 @@ struct ReduceProd<kDLGPU, DType> {
   static __device__ __forceinline__ void Call(DType* addr, DType val) {
     cuda::AtomicMul(addr, val);
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = true;
   static __device__ __forceinline__ DType BackwardCall(DType val, DType accum) {
     return accum / val;
   }
@@ -73,6 +81,8 @@ struct ReduceNone<kDLGPU, DType> {
   static __device__ __forceinline__ void Call(DType* addr, DType val) {
     *addr = val;
   }
+  // whether BackwardCall reads the accumulated value
+  static constexpr bool kBackwardReadsAccum = false;
   static __device__ __forceinline__ DType BackwardCall(DType val, DType accum) {
     return 1;
   }
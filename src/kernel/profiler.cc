@@ -0,0 +1,261 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file kernel/profiler.cc
+ * \brief Kernel profiler implementation and C APIs.
+ */
+#include "./profiler.h"
+
+#include <dgl/packed_func_ext.h>
+#include <dgl/immutable_graph.h>
+#include <dgl/runtime/device_api.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "./utils.h"
+#include "../c_api_common.h"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace kernel {
+namespace {
+
+// Map std::thread::id to small integers for readable traces.
+int ThreadId() {
+  static std::mutex mtx;
+  static std::unordered_map<std::thread::id, int> ids;
+  thread_local int tid = -1;
+  if (tid < 0) {
+    std::lock_guard<std::mutex> lock(mtx);
+    tid = ids.emplace(std::this_thread::get_id(), ids.size()).first->second;
+  }
+  return tid;
+}
+
+std::string TargetString(int target) {
+  switch (target) {
+    case binary_op::kSrc: return "src";
+    case binary_op::kDst: return "dst";
+    case binary_op::kEdge: return "edge";
+    default: return "none";
+  }
+}
+
+std::string DTypeString(const DLDataType& dtype) {
+  std::ostringstream oss;
+  switch (dtype.code) {
+    case kDLInt: oss << "int"; break;
+    case kDLUInt: oss << "uint"; break;
+    case kDLFloat: oss << "float"; break;
+    default: oss << "unknown"; break;
+  }
+  oss << static_cast<int>(dtype.bits);
+  return oss.str();
+}
+
+// Key used to group calls of the same configuration.
+std::string RecordKey(const KernelCallRecord& rec) {
+  std::ostringstream oss;
+  oss << rec.name << "(" << rec.reducer << ", " << rec.op << ", "
+      << TargetString(rec.lhs) << ", " << TargetString(rec.rhs) << ", "
+      << DTypeString(rec.dtype) << ")";
+  return oss.str();
+}
+
+// Escape a string for JSON output.
+std::string JSONEscape(const std::string& str) {
+  std::string ret;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      ret.push_back('\\');
+    }
+    ret.push_back(c);
+  }
+  return ret;
+}
+
+}  // namespace
+
+constexpr size_t KernelProfiler::kMaxTraceEvents;
+constexpr int KernelProfiler::kNumBuckets;
+
+KernelProfiler::KernelProfiler() : epoch_(std::chrono::steady_clock::now()) {
+  const char* val = getenv("DGL_KERNEL_PROFILE");
+  if (val != nullptr && atoi(val) != 0) {
+    SetEnabled(true);
+  }
+}
+
+KernelProfiler* KernelProfiler::Global() {
+  static KernelProfiler inst;
+  return &inst;
+}
+
+int64_t KernelProfiler::NowMicros() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - epoch_).count();
+}
+
+void KernelProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  stats_.clear();
+}
+
+void KernelProfiler::Record(KernelCallRecord&& record) {
+  record.thread_id = ThreadId();
+  const std::string key = RecordKey(record);
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stat& stat = stats_[key];
+  if (stat.count == 0) {
+    stat.buckets.resize(kNumBuckets, 0);
+    stat.min_ns = record.duration_ns;
+    stat.max_ns = record.duration_ns;
+  }
+  ++stat.count;
+  stat.total_ns += record.duration_ns;
+  stat.min_ns = std::min(stat.min_ns, record.duration_ns);
+  stat.max_ns = std::max(stat.max_ns, record.duration_ns);
+  stat.bytes += record.bytes;
+  stat.num_edges += record.num_edges;
+  // bucket i holds calls taking [2^(i-1), 2^i) microseconds
+  int bucket = 0;
+  for (int64_t us = record.duration_ns / 1000; us > 0 && bucket < kNumBuckets - 1; us >>= 1) {
+    ++bucket;
+  }
+  ++stat.buckets[bucket];
+  if (events_.size() < kMaxTraceEvents) {
+    events_.push_back(std::move(record));
+  }
+}
+
+std::string KernelProfiler::Summary() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(3);
+  for (const auto& kv : stats_) {
+    const Stat& stat = kv.second;
+    const double total_ms = stat.total_ns / 1e6;
+    oss << kv.first << "\n"
+        << "  calls: " << stat.count
+        << "  total: " << total_ms << " ms"
+        << "  mean: " << total_ms / stat.count << " ms"
+        << "  min: " << stat.min_ns / 1e6 << " ms"
+        << "  max: " << stat.max_ns / 1e6 << " ms\n"
+        << "  edges: " << stat.num_edges
+        << "  bytes: " << stat.bytes
+        << "  bandwidth: " << (stat.total_ns > 0 ? stat.bytes / (stat.total_ns / 1e9) / 1e9 : 0.)
+        << " GB/s\n";
+    for (int i = 0; i < kNumBuckets; ++i) {
+      if (stat.buckets[i] == 0) {
+        continue;
+      }
+      const int64_t lo = (i == 0) ? 0 : (1LL << (i - 1));
+      oss << "  [" << lo << ", " << (1LL << i) << ") us: " << stat.buckets[i] << "\n";
+    }
+  }
+  return oss.str();
+}
+
+std::string KernelProfiler::ChromeTrace() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream oss;
+  oss << "{\"traceEvents\": [";
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const KernelCallRecord& rec = events_[i];
+    if (i != 0) {
+      oss << ",";
+    }
+    oss << "\n{\"name\": \"" << JSONEscape(rec.name) << "\""
+        << ", \"cat\": \"kernel\", \"ph\": \"X\""
+        << ", \"ts\": " << rec.start_us
+        << ", \"dur\": " << std::fixed << std::setprecision(3) << rec.duration_ns / 1e3
+        << ", \"pid\": 0, \"tid\": " << rec.thread_id
+        << ", \"args\": {"
+        << "\"op\": \"" << JSONEscape(rec.op) << "\""
+        << ", \"reducer\": \"" << JSONEscape(rec.reducer) << "\""
+        << ", \"lhs\": \"" << TargetString(rec.lhs) << "\""
+        << ", \"rhs\": \"" << TargetString(rec.rhs) << "\""
+        << ", \"num_edges\": " << rec.num_edges
+        << ", \"x_length\": " << rec.x_length
+        << ", \"dtype\": \"" << DTypeString(rec.dtype) << "\""
+        << ", \"bytes\": " << rec.bytes
+        << "}}";
+  }
+  oss << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  return oss.str();
+}
+
+KernelProfileScope::~KernelProfileScope() {
+  if (active_) {
+    if (ctx_.device_type != kDLCPU) {
+      DeviceAPI::Get(ctx_)->StreamSync(ctx_, nullptr);
+    }
+    record_.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    KernelProfiler::Global()->Record(std::move(record_));
+  }
+}
+
+void KernelProfileScope::Annotate(
+    const std::string& op, const std::string& reducer,
+    int lhs, int rhs, const ImmutableGraph* graph,
+    NDArray out_data,
+    const std::vector<NDArray>& arrays) {
+  record_.op = op;
+  record_.reducer = reducer;
+  record_.lhs = lhs;
+  record_.rhs = rhs;
+  record_.num_edges = graph->NumEdges();
+  record_.x_length = utils::ComputeXLength(out_data);
+  record_.dtype = out_data->dtype;
+  // graph structure: indptr, indices and edge ids of one CSR
+  int64_t bytes = (graph->NumVertices() + 1 + 2 * graph->NumEdges()) * graph->NumBits() / 8;
+  for (const auto& arr : arrays) {
+    if (!utils::IsNoneArray(arr)) {
+      bytes += utils::NElements(arr) * arr->dtype.bits / 8;
+    }
+  }
+  record_.bytes = bytes;
+  ctx_ = out_data->ctx;
+  if (ctx_.device_type != kDLCPU) {
+    // wait for the work queued before the call and restart the clock
+    DeviceAPI::Get(ctx_)->StreamSync(ctx_, nullptr);
+    record_.start_us = KernelProfiler::Global()->NowMicros();
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelProfilerSetEnabled")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    bool enabled = args[0];
+    KernelProfiler::Global()->SetEnabled(enabled);
+  });
+
+DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelProfilerEnabled")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    *rv = KernelProfiler::Global()->Enabled();
+  });
+
+DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelProfilerReset")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    KernelProfiler::Global()->Reset();
+  });
+
+DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelProfilerSummary")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    *rv = KernelProfiler::Global()->Summary();
+  });
+
+DGL_REGISTER_GLOBAL("kernel._CAPI_DGLKernelProfilerChromeTrace")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    *rv = KernelProfiler::Global()->ChromeTrace();
+  });
+
+}  // namespace kernel
+}  // namespace dgl
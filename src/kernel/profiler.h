@@ -0,0 +1,185 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file kernel/profiler.h
+ * \brief Optional instrumentation of the kernel C APIs.
+ */
+#ifndef DGL_KERNEL_PROFILER_H_
+#define DGL_KERNEL_PROFILER_H_
+
+#include <dgl/runtime/ndarray.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "./binary_reduce_common.h"
+
+namespace dgl {
+
+// forward declaration
+class ImmutableGraph;
+
+namespace kernel {
+
+/*! \brief Information of one kernel call. */
+struct KernelCallRecord {
+  // name of the C API, e.g. "BinaryOpReduce"
+  std::string name;
+  // binary operator and reducer
+  std::string op, reducer;
+  // operand targets
+  int lhs{binary_op::kNone}, rhs{binary_op::kNone};
+  // number of edges of the graph
+  int64_t num_edges{0};
+  // length along x(feature) dimension of the output
+  int64_t x_length{0};
+  // dtype of the output feature
+  DLDataType dtype{kDLFloat, 32, 1};
+  // estimated number of bytes read and written
+  int64_t bytes{0};
+  // start time in microseconds since the profiler epoch
+  int64_t start_us{0};
+  // wall time in nanoseconds; on GPU it includes the execution of the kernels
+  int64_t duration_ns{0};
+  // id of the calling thread
+  int thread_id{0};
+};
+
+/*!
+ * \brief Global kernel profiler.
+ *
+ * The profiler is disabled by default, or enabled at startup if the
+ * environment variable DGL_KERNEL_PROFILE is set to a non-zero value.
+ * When disabled, the only cost of an instrumented call is one relaxed atomic
+ * load. When enabled, every call is aggregated into a per-configuration
+ * histogram of the wall time, and kept as a trace event which can be dumped
+ * in the Chrome trace format (chrome://tracing).
+ */
+class KernelProfiler {
+ public:
+  /*! \brief Maximum number of trace events kept. Later calls are only aggregated. */
+  static constexpr size_t kMaxTraceEvents = 1 << 20;
+  /*! \brief Number of log2 buckets of the wall time histogram (in microseconds). */
+  static constexpr int kNumBuckets = 32;
+
+  /*! \return the global profiler */
+  static KernelProfiler* Global();
+
+  /*! \return true if the profiler is enabled */
+  bool Enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /*! \brief Enable or disable the profiler. */
+  void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  /*! \brief Clear all the recorded calls. */
+  void Reset();
+
+  /*! \brief Record a finished call. */
+  void Record(KernelCallRecord&& record);
+
+  /*! \return the time in microseconds since the profiler epoch */
+  int64_t NowMicros() const;
+
+  /*!
+   * \brief Return a human-readable summary. Calls are grouped by the name,
+   *        op, reducer, targets and dtype, and for each group the number of
+   *        calls, the total/min/max wall time, the bytes touched and the
+   *        histogram of the wall time are reported.
+   */
+  std::string Summary() const;
+
+  /*! \return the recorded calls in Chrome trace event JSON format. */
+  std::string ChromeTrace() const;
+
+ private:
+  /*! \brief Aggregated statistics of one call configuration. */
+  struct Stat {
+    int64_t count{0};
+    int64_t total_ns{0};
+    int64_t min_ns{0};
+    int64_t max_ns{0};
+    int64_t bytes{0};
+    int64_t num_edges{0};
+    std::vector<int64_t> buckets;
+  };
+
+  KernelProfiler();
+
+  std::atomic<bool> enabled_{false};
+  std::chrono::steady_clock::time_point epoch_;
+  mutable std::mutex mutex_;
+  std::vector<KernelCallRecord> events_;
+  std::map<std::string, Stat> stats_;
+};
+
+/*!
+ * \brief RAII helper to time one kernel call.
+ *
+ * If the output is on a GPU, Annotate and the destructor synchronize the
+ * stream, so that the time covers the execution of the kernels rather than
+ * their launch, and not the work queued before the call.
+ *
+ * Usage:
+ *
+ *   KernelProfileScope prof("BinaryOpReduce");
+ *   if (prof.Active()) {
+ *     prof.Annotate(op, reducer, lhs, rhs, graph, out_data, {lhs_data, rhs_data, out_data});
+ *   }
+ *   ... the call ...
+ *
+ * Annotation is guarded so that no argument is touched when the profiler
+ * is disabled.
+ */
+class KernelProfileScope {
+ public:
+  explicit KernelProfileScope(const char* name) {
+    KernelProfiler* prof = KernelProfiler::Global();
+    if (prof->Enabled()) {
+      active_ = true;
+      record_.name = name;
+      record_.start_us = prof->NowMicros();
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~KernelProfileScope();
+
+  /*! \return true if the call is being profiled */
+  bool Active() const {
+    return active_;
+  }
+
+  /*!
+   * \brief Describe the call.
+   * \param op The binary operator.
+   * \param reducer The reducer.
+   * \param lhs The lhs target.
+   * \param rhs The rhs target.
+   * \param graph The graph object.
+   * \param out_data The output feature tensor, used for feature length and dtype.
+   * \param arrays All the feature tensors read or written by the call.
+   */
+  void Annotate(const std::string& op, const std::string& reducer,
+                int lhs, int rhs, const ImmutableGraph* graph,
+                runtime::NDArray out_data,
+                const std::vector<runtime::NDArray>& arrays);
+
+ private:
+  bool active_{false};
+  // the context of the output, which is synchronized if it is a GPU
+  DLContext ctx_{kDLCPU, 0};
+  std::chrono::steady_clock::time_point start_;
+  KernelCallRecord record_;
+};
+
+}  // namespace kernel
+}  // namespace dgl
+
+#endif  // DGL_KERNEL_PROFILER_H_
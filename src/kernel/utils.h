@@ -67,6 +67,15 @@ minigun::Csr<Idx> CreateCsr(runtime::NDArray indptr, runtime::NDArray indices) {
   return csr;
 }
 
+/*
+ * !\brief Return the edge id mapping of a CSR graph, or nullptr if the edge
+ * ids are implicit (i.e., the identity mapping).
+ */
+template <typename Idx>
+Idx* EdgeIdMapping(runtime::NDArray edge_ids) {
+  return edge_ids.defined() ? static_cast<Idx*>(edge_ids->data) : nullptr;
+}
+
 }  // namespace utils
 }  // namespace kernel
 }  // namespace dgl
@@ -179,6 +179,22 @@ NDArray NDArray::EmptyShared(const std::string &name,
   return ret;
 }
 
+NDArray NDArray::MapFile(const std::string &path) {
+#ifndef _WIN32
+  auto mem = std::make_shared<SharedMemory>(path);
+  size_t size = 0;
+  void* ptr = mem->map_file(&size);
+  NDArray ret = Internal::Create({static_cast<int64_t>(size)},
+                                 DLDataType{kDLInt, 8, 1}, DLContext{kDLCPU, 0});
+  ret.data_->dl_tensor.data = ptr;
+  ret.data_->mem = mem;
+  return ret;
+#else
+  LOG(FATAL) << "Windows doesn't support NDArray backed by a file mapping";
+  return NDArray();
+#endif  // _WIN32
+}
+
 NDArray NDArray::Empty(std::vector<int64_t> shape,
                        DLDataType dtype,
                        DLContext ctx) {
@@ -5,6 +5,7 @@
  */
 #ifndef _WIN32
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #endif
@@ -58,6 +59,20 @@ void *SharedMemory::open(size_t size) {
       << "Failed to map shared memory. mmap failed with error " << strerror(errno);
   return ptr;
 }
+
+void *SharedMemory::map_file(size_t *size) {
+  fd = ::open(name.c_str(), O_RDONLY);
+  CHECK_NE(fd, -1) << "fail to open " << name << ": " << strerror(errno);
+  struct stat st;
+  CHECK_NE(fstat(fd, &st), -1) << "fail to stat " << name << ": " << strerror(errno);
+  CHECK_GT(st.st_size, 0) << "empty file " << name;
+  this->size = st.st_size;
+  ptr = mmap(NULL, this->size, PROT_READ, MAP_SHARED, fd, 0);
+  CHECK_NE(ptr, MAP_FAILED)
+      << "Failed to map file. mmap failed with error " << strerror(errno);
+  *size = this->size;
+  return ptr;
+}
 #endif  // _WIN32
 
 }  // namespace runtime
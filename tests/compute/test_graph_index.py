@@ -184,6 +184,50 @@ def test_load_csr():
         assert np.all(F.asnumpy(src) == coo.row)
         assert np.all(F.asnumpy(dst) == coo.col)
 
+def test_save_load():
+    # memory mapping isn't supported in Windows.
+    if os.name == 'nt':
+        return
+    import tempfile
+    _, ig = generate_rand_graph(100)
+    path = os.path.join(tempfile.mkdtemp(), 'graph.bin')
+    ig.save(path)
+    lg = dgl.graph_index.from_file(path)
+    assert lg.number_of_nodes() == ig.number_of_nodes()
+    assert lg.number_of_edges() == ig.number_of_edges()
+    check_graph_equal(ig, lg)
+    src1, dst1, eid1 = ig.edges('eid')
+    src2, dst2, eid2 = lg.edges('eid')
+    assert np.all(src1.tonumpy() == src2.tonumpy())
+    assert np.all(dst1.tonumpy() == dst2.tonumpy())
+    assert np.all(eid1.tonumpy() == eid2.tonumpy())
+    os.remove(path)
+
+def test_load_edge_list():
+    if os.name == 'nt':
+        return
+    import tempfile
+    path = os.path.join(tempfile.mkdtemp(), 'edges.txt')
+    with open(path, 'w') as f:
+        f.write('# src dst weight\n3,1,0.5\n0 2\n\n2\t2\n0 2\n1 0\n')
+    g = dgl.graph_index.from_edge_list_file(path)
+    assert g.number_of_nodes() == 4
+    src, dst, eid = g.edges('eid')
+    assert list(zip(src.tonumpy(), dst.tonumpy())) == [(3, 1), (0, 2), (2, 2), (0, 2), (1, 0)]
+    assert g.is_multigraph()
+    g = dgl.graph_index.from_edge_list_file(path, num_nodes=10, remove_self_loops=True,
+                                            remove_duplicates=True, num_bits=32)
+    assert g.number_of_nodes() == 10
+    src, dst, eid = g.edges('eid')
+    assert list(zip(src.tonumpy(), dst.tonumpy())) == [(3, 1), (0, 2), (1, 0)]
+    assert not g.is_multigraph()
+    # an empty file is a graph without edges
+    open(path, 'w').close()
+    g = dgl.graph_index.from_edge_list_file(path, num_nodes=3)
+    assert g.number_of_nodes() == 3
+    assert g.number_of_edges() == 0
+    os.remove(path)
+
 def test_edge_ids():
     np.random.seed(0)
     csr = (spsp.random(20, 20, density=0.1, format='csr') != 0).astype(np.int64)
@@ -203,3 +247,5 @@ if __name__ == '__main__':
     test_node_subgraph()
     test_create_graph()
     test_load_csr()
+    test_save_load()
+    test_load_edge_list()
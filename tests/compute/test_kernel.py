@@ -230,7 +230,67 @@ def test_all_binary_builtins():
                 for broadcast in ["none", lhs, rhs]:
                     _test(g, lhs, rhs, binary_op, reducer)
 
+def test_kernel_profiler():
+    import json
+    import os
+    import tempfile
+    from dgl import kernel
+    g = dgl.DGLGraph(nx.erdos_renyi_graph(100, 0.1))
+    hu, hv, he = generate_feature(g, 'none')
+    g.ndata['u'] = hu
+    kernel.reset_profiler()
+    kernel.set_profiler_enabled(True)
+    try:
+        g.update_all(fn.copy_src(src='u', out='m'), fn.sum(msg='m', out='r'))
+    finally:
+        kernel.set_profiler_enabled(False)
+    assert 'CopyReduce(sum, use_lhs, src, none, float32)' in kernel.profiler_summary()
+    fd, path = tempfile.mkstemp(suffix='.json')
+    os.close(fd)
+    kernel.dump_profiler_trace(path)
+    with open(path) as f:
+        events = json.load(f)['traceEvents']
+    os.remove(path)
+    assert len(events) == 1
+    assert events[0]['name'] == 'CopyReduce'
+    assert events[0]['args']['num_edges'] == g.number_of_edges()
+    assert events[0]['args']['x_length'] == D1 * D2 * D3
+    # nothing is recorded once disabled
+    g.update_all(fn.copy_src(src='u', out='m'), fn.sum(msg='m', out='r'))
+    kernel.dump_profiler_trace(path)
+    with open(path) as f:
+        assert len(json.load(f)['traceEvents']) == 1
+    os.remove(path)
+    kernel.reset_profiler()
+
+def test_edge_cache():
+    from dgl import kernel
+    g = dgl.DGLGraph(nx.erdos_renyi_graph(100, 0.1))
+    hu, hv, he = generate_feature(g, 'e')
+
+    def _run(reducer):
+        g.ndata['u'] = F.attach_grad(F.clone(hu))
+        g.edata['e'] = F.attach_grad(F.clone(he))
+        with F.record_grad():
+            g.update_all(fn.u_mul_e('u', 'e', 'm'), getattr(fn, reducer)('m', 'r'))
+            r = g.ndata['r']
+            F.backward(r.sum())
+        return r, F.grad(g.ndata['u']), F.grad(g.edata['e'])
+
+    for reducer in ['sum', 'max']:
+        r1, gu1, ge1 = _run(reducer)
+        kernel.set_edge_cache_limit(1 << 30)
+        try:
+            r2, gu2, ge2 = _run(reducer)
+        finally:
+            kernel.set_edge_cache_limit(0)
+        assert F.allclose(r1, r2)
+        assert F.allclose(gu1, gu2)
+        assert F.allclose(ge1, ge2)
+
 if __name__ == '__main__':
     test_copy_src_reduce()
     test_copy_edge_reduce()
     test_all_binary_builtins()
+    test_kernel_profiler()
+    test_edge_cache()
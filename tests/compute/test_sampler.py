@@ -219,6 +219,51 @@ def test_setseed():
             g, 5, 3, num_hops=2, neighbor_type='in', num_workers=4)):
         pass
 
+def _check_same_nodeflows(g1, g2):
+    for neighbor_type in ['in', 'out']:
+        # expand factor larger than any degree makes the sampling deterministic
+        seed_nodes = F.tensor(np.arange(20), F.int64)
+        nf1 = next(iter(dgl.contrib.sampling.NeighborSampler(
+            g1, 20, 100, num_hops=2, neighbor_type=neighbor_type,
+            seed_nodes=seed_nodes, add_self_loop=True)))
+        nf2 = next(iter(dgl.contrib.sampling.NeighborSampler(
+            g2, 20, 100, num_hops=2, neighbor_type=neighbor_type,
+            seed_nodes=seed_nodes, add_self_loop=True)))
+        assert nf1.number_of_nodes() == nf2.number_of_nodes()
+        assert nf1.number_of_edges() == nf2.number_of_edges()
+        for i in range(nf1.num_layers):
+            assert F.array_equal(nf1.layer_parent_nid(i), nf2.layer_parent_nid(i))
+        for i in range(nf1.num_blocks):
+            src1, dst1, _ = nf1.block_edges(i)
+            src2, dst2, _ = nf2.block_edges(i)
+            assert F.array_equal(src1, src2)
+            assert F.array_equal(dst1, dst2)
+            assert F.array_equal(nf1.block_parent_eid(i), nf2.block_parent_eid(i))
+
+def test_32bit_sampler():
+    g = generate_rand_graph(100)
+    g32 = dgl.DGLGraph(g._graph.asbits(32), readonly=True)
+    _check_same_nodeflows(g, g32)
+
+def test_compressed_sampler():
+    g = generate_rand_graph(100)
+    g._graph.materialize()
+    gidx = g._graph.compress()
+    assert 0 < gidx.compressed_size()
+    cg = dgl.DGLGraph(gidx, readonly=True)
+    _check_same_nodeflows(g, cg)
+    # layer sampling decodes the compressed rows as well
+    seed_nodes = F.tensor(np.arange(20), F.int64)
+    nfs = []
+    for graph in [g, cg]:
+        dgl.random.seed(42)
+        nfs.append(next(iter(dgl.contrib.sampling.LayerSampler(
+            graph, 20, [10, 10], 'in', seed_nodes=seed_nodes, num_workers=1))))
+    for i in range(nfs[0].num_layers):
+        assert F.array_equal(nfs[0].layer_parent_nid(i), nfs[1].layer_parent_nid(i))
+    for i in range(nfs[0].num_blocks):
+        assert F.array_equal(nfs[0].block_parent_eid(i), nfs[1].block_parent_eid(i))
+
 if __name__ == '__main__':
     test_create_full()
     test_1neighbor_sampler_all()
@@ -228,3 +273,5 @@ if __name__ == '__main__':
     test_layer_sampler()
     test_nonuniform_neighbor_sampler()
     test_setseed()
+    test_32bit_sampler()
+    test_compressed_sampler()
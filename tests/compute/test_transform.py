@@ -112,6 +112,30 @@ def test_bidirected_graph():
     _test(False, True)
     _test(False, False)
 
+def test_reorder_nodes():
+    # a path graph with scrambled node ids
+    ids = np.random.RandomState(0).permutation(20)
+    g = dgl.DGLGraph()
+    g.add_nodes(20)
+    g.add_edges(ids[:-1], ids[1:])
+    g.add_edges(ids[1:], ids[:-1])
+    g.ndata['h'] = F.randn((20, D))
+    g.edata['w'] = F.randn((g.number_of_edges(), D))
+    for method in ['degree', 'rcm', 'gorder']:
+        ng, perm = dgl.transform.reorder_nodes(g, method)
+        perm = F.asnumpy(perm)
+        assert sorted(perm) == list(range(20))
+        assert F.allclose(ng.ndata['h'], F.gather_row(g.ndata['h'], F.tensor(perm)))
+        # edges keep their ids
+        src, dst = ng.all_edges(order='eid')
+        osrc, odst = g.all_edges(order='eid')
+        assert np.all(perm[F.asnumpy(src)] == F.asnumpy(osrc))
+        assert np.all(perm[F.asnumpy(dst)] == F.asnumpy(odst))
+        assert F.allclose(ng.edata['w'], g.edata['w'])
+        if method == 'rcm':
+            # a path graph has bandwidth 1
+            assert np.all(np.abs(F.asnumpy(src) - F.asnumpy(dst)) == 1)
+
 if __name__ == '__main__':
     test_line_graph()
     test_no_backtracking()
@@ -119,3 +143,4 @@ if __name__ == '__main__':
     test_reverse_shared_frames()
     test_simple_graph()
     test_bidirected_graph()
+    test_reorder_nodes()
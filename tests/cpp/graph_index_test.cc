@@ -4,10 +4,328 @@
  * \brief Test GraphIndex
  */
 #include <gtest/gtest.h>
+#include <dgl/array.h>
 #include <dgl/graph.h>
+#include <dgl/graph_op.h>
+#include <dgl/immutable_graph.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "./common.h"
 
 TEST(GraphTest, TestNumVertices){
   dgl::Graph g(false);
   g.AddVertices(10);
   ASSERT_EQ(g.NumVertices(), 10);
 };
+
+TEST(ImmutableGraphTest, TestLazyFormats) {
+  auto src = dgl::aten::VecToIdArray(std::vector<int64_t>({0, 0, 1, 2, 3}));
+  auto dst = dgl::aten::VecToIdArray(std::vector<int64_t>({1, 2, 3, 3, 0}));
+  auto g = dgl::ImmutableGraph::CreateFromCOO(4, src, dst);
+  // concurrent requests build the format once and all get the same one
+  const int kNumThreads = 8;
+  std::vector<dgl::CSRPtr> csrs(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&g, &csrs, i] () { csrs[i] = g->GetInCSR(); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    ASSERT_EQ(csrs[i], csrs[0]);
+  }
+  ASSERT_EQ(csrs[0]->NumEdges(), 5);
+  // materialized formats are reused afterwards
+  g->Materialize({"out_csr", "coo"});
+  auto out_csr = g->GetOutCSR();
+  ASSERT_EQ(g->GetOutCSR(), out_csr);
+  ASSERT_EQ(g->GetInCSR(), csrs[0]);
+  ASSERT_EQ(out_csr->SuccVec(3).size(), 1);
+  ASSERT_EQ(csrs[0]->SuccVec(3).size(), 2);
+}
+
+TEST(ImmutableGraphTest, TestCompress) {
+  // a random graph with a few high degree vertices so that the neighbor
+  // lists span multiple bit-packed blocks
+  const int64_t num_vertices = 1000;
+  std::vector<int64_t> src_vec, dst_vec;
+  for (int64_t i = 0; i < 20000; ++i) {
+    src_vec.push_back((i * 7919) % num_vertices);
+    dst_vec.push_back((i % 3 == 0) ? (i * 104729) % 5 : (i * 31337 + 17) % num_vertices);
+  }
+  auto src = dgl::aten::VecToIdArray(src_vec);
+  auto dst = dgl::aten::VecToIdArray(dst_vec);
+  for (uint8_t bits : {32, 64}) {
+    auto g = dgl::ImmutableGraph::AsNumBits(
+        dgl::ImmutableGraph::CreateFromCOO(num_vertices, src, dst), bits);
+    g->Materialize({"in_csr", "out_csr"});
+    auto cg = dgl::ImmutableGraph::Compress(g);
+    ASSERT_TRUE(cg->GetCompressedInCSR() != nullptr);
+    ASSERT_TRUE(cg->GetCompressedOutCSR() != nullptr);
+    ASSERT_EQ(cg->NumVertices(), num_vertices);
+    ASSERT_EQ(cg->NumEdges(), src_vec.size());
+    ASSERT_EQ(cg->NumBits(), bits);
+    ASSERT_EQ(cg->IsMultigraph(), g->IsMultigraph());
+    // compressed rows are decoded on the fly
+    for (bool transpose : {false, true}) {
+      const auto adj = g->GetAdj(transpose, "csr");
+      const auto indptr = dgl::aten::AsNumBits(adj[0], 64);
+      const auto indices = dgl::aten::AsNumBits(adj[1], 64);
+      const auto edge_ids = dgl::aten::AsNumBits(adj[2], 64);
+      for (int64_t v = 0; v < num_vertices; ++v) {
+        const int64_t start = PI64(indptr)[v], end = PI64(indptr)[v + 1];
+        // GetAdj(transpose=false) is the in-edge CSR
+        const auto succ = transpose ? cg->SuccVec(v) : cg->PredVec(v);
+        const auto eids = transpose ? cg->OutEdgeVec(v) : cg->InEdgeVec(v);
+        ASSERT_EQ(transpose ? cg->OutDegree(v) : cg->InDegree(v), end - start);
+        ASSERT_EQ(succ.size(), end - start);
+        ASSERT_EQ(eids.size(), end - start);
+        for (int64_t i = start; i < end; ++i) {
+          ASSERT_EQ(succ[i - start], PI64(indices)[i]);
+          ASSERT_EQ(eids[i - start], PI64(edge_ids)[i]);
+        }
+      }
+      // other operators decompress the csr
+      const auto cadj = cg->GetAdj(transpose, "csr");
+      for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(adj[i], 64),
+                                     dgl::aten::AsNumBits(cadj[i], 64)));
+      }
+    }
+    // the per-vertex queries decode the rows as well
+    for (int64_t v : {0, 1, 2, 500, 999}) {
+      const auto edges = g->OutEdges(v), cedges = cg->OutEdges(v);
+      ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(edges.dst, 64),
+                                   dgl::aten::AsNumBits(cedges.dst, 64)));
+      ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(edges.id, 64),
+                                   dgl::aten::AsNumBits(cedges.id, 64)));
+      ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(g->Predecessors(v), 64),
+                                   dgl::aten::AsNumBits(cg->Predecessors(v), 64)));
+      ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(g->EdgeId(v, 3), 64),
+                                   dgl::aten::AsNumBits(cg->EdgeId(v, 3), 64)));
+      ASSERT_EQ(g->HasEdgeBetween(v, 1), cg->HasEdgeBetween(v, 1));
+    }
+    const auto vids = dgl::aten::AsNumBits(dgl::aten::Range(0, num_vertices, 64, CTX), bits);
+    ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(g->InDegrees(vids), 64),
+                                 dgl::aten::AsNumBits(cg->InDegrees(vids), 64)));
+    // the decompressed formats are only kept when materialized
+    ASSERT_NE(cg->GetOutCSR(), cg->GetOutCSR());
+    cg->Materialize({"out_csr"});
+    ASSERT_EQ(cg->GetOutCSR(), cg->GetOutCSR());
+    ASSERT_NE(cg->GetInCSR(), cg->GetInCSR());
+  }
+}
+
+TEST(ImmutableGraphTest, TestSaveLoad) {
+  const int64_t num_vertices = 1000;
+  std::vector<int64_t> src_vec, dst_vec;
+  for (int64_t i = 0; i < 5000; ++i) {
+    src_vec.push_back((i * 7919) % num_vertices);
+    dst_vec.push_back((i * 31337 + 17) % num_vertices);
+  }
+  auto src = dgl::aten::VecToIdArray(src_vec);
+  auto dst = dgl::aten::VecToIdArray(dst_vec);
+  const std::string path = "test_save_load.dglgraph";
+  for (uint8_t bits : {32, 64}) {
+    auto g = dgl::ImmutableGraph::AsNumBits(
+        dgl::ImmutableGraph::CreateFromCOO(num_vertices, src, dst), bits);
+    g->Materialize({"in_csr", "out_csr"});
+    g->Save(path);
+    auto lg = dgl::ImmutableGraph::Load(path);
+    ASSERT_EQ(lg->NumVertices(), num_vertices);
+    ASSERT_EQ(lg->NumEdges(), src_vec.size());
+    ASSERT_EQ(lg->NumBits(), bits);
+    ASSERT_EQ(lg->IsMultigraph(), g->IsMultigraph());
+    for (bool transpose : {false, true}) {
+      const auto adj = g->GetAdj(transpose, "csr");
+      const auto ladj = lg->GetAdj(transpose, "csr");
+      for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(adj[i], 64),
+                                     dgl::aten::AsNumBits(ladj[i], 64)));
+      }
+    }
+  }
+
+  // implicit edge ids are not stored and stay implicit
+  auto csr = dgl::ImmutableGraph::CreateFromCOO(num_vertices, src, dst)->GetOutCSR();
+  auto g = dgl::ImmutableGraph::CreateFromCSR(
+      csr->indptr(), csr->indices(), dgl::IdArray(), "out");
+  g->Save(path);
+  auto lg = dgl::ImmutableGraph::Load(path);
+  ASSERT_FALSE(lg->GetOutCSR()->edge_ids().defined());
+  ASSERT_TRUE(ArrayEQ<int64_t>(lg->GetAdj(true, "csr")[2],
+                               g->GetAdj(true, "csr")[2]));
+  // the mapped csr cannot be modified, but its transpose can
+  ASSERT_TRUE(lg->GetOutCSR()->IsMapped());
+  ASSERT_FALSE(lg->GetInCSR()->IsMapped());
+
+  // a corrupted file fails the checksum; the indices start after the header
+  // page and the two pages of the indptr
+  {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(3 * 4096 + 8);
+    f.put(0x7f);
+  }
+  ASSERT_THROW(dgl::ImmutableGraph::Load(path), dmlc::Error);
+  ASSERT_NO_THROW(dgl::ImmutableGraph::Load(path, false));
+  // out-of-range ids are rejected even without the checksum
+  {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(3 * 4096 + 15);
+    f.put(0x7f);
+  }
+  ASSERT_THROW(dgl::ImmutableGraph::Load(path, false), dmlc::Error);
+  // so is a corrupted indptr
+  {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(3 * 4096 + 15);
+    f.put(0);
+    f.seekp(4096 + 8);
+    f.put(0x7f);
+  }
+  ASSERT_THROW(dgl::ImmutableGraph::Load(path, false), dmlc::Error);
+  std::remove(path.c_str());
+}
+
+TEST(ImmutableGraphTest, TestLoadEdgeList) {
+  // large enough for the files to be parsed in parallel
+  const int64_t num_vertices = 1000;
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i < 20000; ++i) {
+    edges.emplace_back((i * 7919) % num_vertices, (i * 31337 + 17) % 50);
+  }
+  const std::string path = "test_load_edge_list.txt";
+  {
+    std::ofstream f(path);
+    f << "# src dst\n";
+    for (size_t i = 0; i < edges.size(); ++i) {
+      f << edges[i].first << (i % 2 ? "," : "\t") << edges[i].second << " 1.0\n";
+    }
+  }
+  const std::string bin_path = "test_load_edge_list.bin";
+  {
+    std::ofstream f(bin_path, std::ios::binary);
+    for (const auto& e : edges) {
+      const int32_t pair[2] = {static_cast<int32_t>(e.first), static_cast<int32_t>(e.second)};
+      f.write(reinterpret_cast<const char*>(pair), sizeof(pair));
+    }
+  }
+
+  for (bool simple : {false, true}) {
+    // the kept edges are numbered in file order and sorted by (src, dst, id)
+    std::vector<std::tuple<int64_t, int64_t, int64_t>> expected;
+    std::set<std::pair<int64_t, int64_t>> seen;
+    for (const auto& e : edges) {
+      if (simple && (e.first == e.second || !seen.insert(e).second)) {
+        continue;
+      }
+      expected.emplace_back(e.first, e.second, expected.size());
+    }
+    std::sort(expected.begin(), expected.end());
+    for (uint8_t bits : {32, 64}) {
+      auto g = dgl::ImmutableGraph::LoadEdgeList(path, "text", -1, simple, simple, bits);
+      auto bg = dgl::ImmutableGraph::LoadEdgeList(bin_path, "int32", -1, simple, simple, bits);
+      ASSERT_EQ(g->NumBits(), bits);
+      ASSERT_EQ(g->NumVertices(), num_vertices);
+      ASSERT_EQ(g->NumEdges(), expected.size());
+      ASSERT_EQ(g->IsMultigraph(), !simple);
+      const auto adj = g->GetAdj(true, "csr");
+      const auto badj = bg->GetAdj(true, "csr");
+      for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ArrayEQ<int64_t>(dgl::aten::AsNumBits(adj[i], 64),
+                                     dgl::aten::AsNumBits(badj[i], 64)));
+      }
+      const auto indptr = dgl::aten::AsNumBits(adj[0], 64);
+      const auto indices = dgl::aten::AsNumBits(adj[1], 64);
+      const auto eids = dgl::aten::AsNumBits(adj[2], 64);
+      for (int64_t v = 0; v < num_vertices; ++v) {
+        for (int64_t i = PI64(indptr)[v]; i < PI64(indptr)[v + 1]; ++i) {
+          ASSERT_EQ(std::get<0>(expected[i]), v);
+          ASSERT_EQ(std::get<1>(expected[i]), PI64(indices)[i]);
+          ASSERT_EQ(std::get<2>(expected[i]), PI64(eids)[i]);
+        }
+      }
+    }
+  }
+  auto g = dgl::ImmutableGraph::LoadEdgeList(path, "text", 2000, false, false, 64);
+  ASSERT_EQ(g->NumVertices(), 2000);
+  ASSERT_ANY_THROW(dgl::ImmutableGraph::LoadEdgeList(path, "text", 10, false, false, 64));
+
+  // ids that do not fit in 64 bits are malformed
+  {
+    std::ofstream f(path);
+    f << "0 1\n1 99999999999999999999\n";
+  }
+  ASSERT_ANY_THROW(dgl::ImmutableGraph::LoadEdgeList(path, "text", -1, false, false, 64));
+  // an empty file is an empty graph
+  {
+    std::ofstream f(path);
+  }
+  g = dgl::ImmutableGraph::LoadEdgeList(path, "text", -1, false, false, 64);
+  ASSERT_EQ(g->NumVertices(), 0);
+  ASSERT_EQ(g->NumEdges(), 0);
+  g = dgl::ImmutableGraph::LoadEdgeList(path, "int32", 5, false, false, 32);
+  ASSERT_EQ(g->NumVertices(), 5);
+  ASSERT_EQ(g->NumEdges(), 0);
+  std::remove(path.c_str());
+  std::remove(bin_path.c_str());
+}
+
+TEST(GraphOpTest, TestReorderVertices) {
+  // a grid graph with scrambled vertex ids
+  const int64_t rows = 30, cols = 40, num_vertices = rows * cols;
+  std::vector<int64_t> ids(num_vertices);
+  for (int64_t i = 0; i < num_vertices; ++i) {
+    ids[i] = (i * 7919) % num_vertices;
+  }
+  std::vector<int64_t> src_vec, dst_vec;
+  for (int64_t r = 0; r < rows; ++r) {
+    for (int64_t c = 0; c < cols; ++c) {
+      if (c + 1 < cols) {
+        src_vec.push_back(ids[r * cols + c]);
+        dst_vec.push_back(ids[r * cols + c + 1]);
+      }
+      if (r + 1 < rows) {
+        src_vec.push_back(ids[(r + 1) * cols + c]);
+        dst_vec.push_back(ids[r * cols + c]);
+      }
+    }
+  }
+  for (uint8_t bits : {32, 64}) {
+    auto g = dgl::ImmutableGraph::AsNumBits(dgl::ImmutableGraph::CreateFromCOO(
+        num_vertices, dgl::aten::VecToIdArray(src_vec), dgl::aten::VecToIdArray(dst_vec)), bits);
+    for (const std::string method : {"degree", "rcm", "gorder"}) {
+      auto ret = dgl::GraphOp::ReorderVertices(g, method);
+      auto ng = ret.first;
+      const auto perm = dgl::aten::AsNumBits(ret.second, 64);
+      ASSERT_EQ(ng->NumBits(), bits);
+      ASSERT_EQ(ng->NumVertices(), num_vertices);
+      ASSERT_EQ(ng->NumEdges(), src_vec.size());
+      std::vector<int64_t> sorted_perm(PI64(perm), PI64(perm) + num_vertices);
+      std::sort(sorted_perm.begin(), sorted_perm.end());
+      for (int64_t i = 0; i < num_vertices; ++i) {
+        ASSERT_EQ(sorted_perm[i], i);
+      }
+      // the edges keep their ids
+      const auto edges = ng->Edges("eid");
+      const auto src = dgl::aten::AsNumBits(edges.src, 64);
+      const auto dst = dgl::aten::AsNumBits(edges.dst, 64);
+      int64_t bandwidth = 0;
+      for (size_t e = 0; e < src_vec.size(); ++e) {
+        ASSERT_EQ(PI64(perm)[PI64(src)[e]], src_vec[e]);
+        ASSERT_EQ(PI64(perm)[PI64(dst)[e]], dst_vec[e]);
+        bandwidth = std::max(bandwidth, std::abs(PI64(src)[e] - PI64(dst)[e]));
+      }
+      if (method == "rcm") {
+        // the bandwidth of a grid is its smaller side
+        ASSERT_TRUE(bandwidth <= rows + 1);
+      }
+    }
+  }
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <dgl/array.h>
 #include "./common.h"
 
@@ -189,6 +190,143 @@ TEST(SpmatTest, TestCSRGetDataAndIndices) {
   _TestCSRGetDataAndIndices<int64_t>();
 }
 
+template <typename IDX>
+void _TestCSRBatchedLookup() {
+  // rows of random lengths with duplicate columns; the unsorted matrix is
+  // the sorted one with each row reversed
+  const int64_t num_rows = 500, num_cols = 50;
+  std::vector<IDX> indptr(1, 0), sorted_indices, unsorted_indices;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    std::vector<IDX> row;
+    for (int64_t j = 0; j < (i * 37) % 23; ++j) {
+      row.push_back((i * 13 + j * j) % num_cols);
+    }
+    std::sort(row.begin(), row.end());
+    sorted_indices.insert(sorted_indices.end(), row.begin(), row.end());
+    unsorted_indices.insert(unsorted_indices.end(), row.rbegin(), row.rend());
+    indptr.push_back(sorted_indices.size());
+  }
+  const int64_t nnz = sorted_indices.size();
+  std::vector<IDX> unsorted_data(nnz);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    for (IDX j = indptr[i]; j < indptr[i + 1]; ++j) {
+      unsorted_data[j] = indptr[i] + indptr[i + 1] - 1 - j;
+    }
+  }
+  aten::CSRMatrix sorted(num_rows, num_cols,
+                         aten::VecToIdArray(indptr, sizeof(IDX)*8, CTX),
+                         aten::VecToIdArray(sorted_indices, sizeof(IDX)*8, CTX));
+  aten::CSRMatrix unsorted(num_rows, num_cols,
+                           aten::VecToIdArray(indptr, sizeof(IDX)*8, CTX),
+                           aten::VecToIdArray(unsorted_indices, sizeof(IDX)*8, CTX),
+                           aten::VecToIdArray(unsorted_data, sizeof(IDX)*8, CTX));
+  ASSERT_TRUE(aten::CSRIsSorted(sorted));
+  ASSERT_FALSE(aten::CSRIsSorted(unsorted));
+  sorted.sorted = true;
+
+  // enough queries to be processed in parallel
+  std::vector<IDX> rows, cols;
+  for (int64_t i = 0; i < 20000; ++i) {
+    rows.push_back((i * 7) % num_rows);
+    cols.push_back((i * 11) % num_cols);
+  }
+  auto r = aten::VecToIdArray(rows, sizeof(IDX)*8, CTX);
+  auto c = aten::VecToIdArray(cols, sizeof(IDX)*8, CTX);
+  std::vector<IDX> tr, tc, td, tnz;
+  for (size_t q = 0; q < rows.size(); ++q) {
+    tnz.push_back(0);
+    for (IDX j = indptr[rows[q]]; j < indptr[rows[q] + 1]; ++j) {
+      if (sorted_indices[j] == cols[q]) {
+        tr.push_back(rows[q]);
+        tc.push_back(cols[q]);
+        td.push_back(j);
+        tnz.back() = 1;
+      }
+    }
+  }
+  for (const auto& csr : {sorted, unsorted}) {
+    auto x = aten::CSRGetDataAndIndices(csr, r, c);
+    ASSERT_TRUE(ArrayEQ<IDX>(x[0], aten::VecToIdArray(tr, sizeof(IDX)*8, CTX)));
+    ASSERT_TRUE(ArrayEQ<IDX>(x[1], aten::VecToIdArray(tc, sizeof(IDX)*8, CTX)));
+    // the duplicates of a query come in the order of the matrix
+    auto d = aten::CSRGetData(csr, r, c);
+    ASSERT_TRUE(ArrayEQ<IDX>(x[2], d));
+    if (csr.sorted) {
+      ASSERT_TRUE(ArrayEQ<IDX>(d, aten::VecToIdArray(td, sizeof(IDX)*8, CTX)));
+    }
+    auto nz = aten::CSRIsNonZero(csr, r, c);
+    ASSERT_TRUE(ArrayEQ<IDX>(nz, aten::VecToIdArray(tnz, sizeof(IDX)*8, CTX)));
+  }
+  // broadcasting
+  auto r0 = aten::VecToIdArray(std::vector<IDX>({rows[1]}), sizeof(IDX)*8, CTX);
+  auto nz = aten::CSRIsNonZero(sorted, r0, c);
+  for (size_t q = 0; q < cols.size(); ++q) {
+    ASSERT_EQ(static_cast<IDX*>(nz->data)[q], aten::CSRIsNonZero(unsorted, rows[1], cols[q]));
+  }
+}
+
+TEST(SpmatTest, TestCSRBatchedLookup) {
+  _TestCSRBatchedLookup<int32_t>();
+  _TestCSRBatchedLookup<int64_t>();
+}
+
+template <typename IDX>
+void _TestCSRSliceMatrixLarge(int64_t num_cols, int64_t num_sub_cols) {
+  // enough rows to be sliced in parallel; the column ids are spread over
+  // num_cols, and the sub columns contain duplicates
+  const int64_t num_rows = 5000;
+  std::vector<IDX> indptr(1, 0), indices, data;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    for (int64_t j = 0; j < i % 17; ++j) {
+      indices.push_back((i * 7919 + j * 104729) % num_cols);
+      data.push_back(indices.size() * 3);
+    }
+    indptr.push_back(indices.size());
+  }
+  aten::CSRMatrix csr(num_rows, num_cols,
+                      aten::VecToIdArray(indptr, sizeof(IDX)*8, CTX),
+                      aten::VecToIdArray(indices, sizeof(IDX)*8, CTX),
+                      aten::VecToIdArray(data, sizeof(IDX)*8, CTX));
+  std::vector<IDX> rows, cols;
+  for (int64_t i = 0; i < num_rows / 2; ++i) {
+    rows.push_back((i * 3) % num_rows);
+  }
+  std::vector<IDX> newj(num_cols, -1);
+  for (int64_t j = 0; j < num_sub_cols; ++j) {
+    cols.push_back((j * 31) % num_cols);
+    if (newj[cols.back()] == -1) {
+      newj[cols.back()] = j;
+    }
+  }
+  std::vector<IDX> tindptr(1, 0), tindices, tdata;
+  for (IDX i : rows) {
+    for (IDX p = indptr[i]; p < indptr[i + 1]; ++p) {
+      if (newj[indices[p]] != -1) {
+        tindices.push_back(newj[indices[p]]);
+        tdata.push_back(data[p]);
+      }
+    }
+    tindptr.push_back(tindices.size());
+  }
+  auto x = aten::CSRSliceMatrix(csr,
+      aten::VecToIdArray(rows, sizeof(IDX)*8, CTX),
+      aten::VecToIdArray(cols, sizeof(IDX)*8, CTX));
+  ASSERT_EQ(x.num_rows, static_cast<int64_t>(rows.size()));
+  ASSERT_EQ(x.num_cols, num_sub_cols);
+  ASSERT_TRUE(ArrayEQ<IDX>(x.indptr, aten::VecToIdArray(tindptr, sizeof(IDX)*8, CTX)));
+  ASSERT_TRUE(ArrayEQ<IDX>(x.indices, aten::VecToIdArray(tindices, sizeof(IDX)*8, CTX)));
+  ASSERT_TRUE(ArrayEQ<IDX>(x.data, aten::VecToIdArray(tdata, sizeof(IDX)*8, CTX)));
+}
+
+TEST(SpmatTest, TestCSRSliceMatrixLarge) {
+  // a dense relabel table
+  _TestCSRSliceMatrixLarge<int32_t>(1000, 300);
+  _TestCSRSliceMatrixLarge<int64_t>(1000, 300);
+  // a hash map
+  _TestCSRSliceMatrixLarge<int32_t>(100000, 300);
+  _TestCSRSliceMatrixLarge<int64_t>(100000, 300);
+}
+
 template <typename IDX>
 void _TestCSRTranspose() {
   auto csr = CSR2<IDX>();
@@ -304,6 +442,52 @@ TEST(SpmatTest, TestCSRSliceMatrix) {
   _TestCSRSliceMatrix<int64_t>();
 }
 
+template <typename IDX>
+void _TestCSRNoData() {
+  // a missing data array is the same as data [0, 1, ..., nnz - 1]
+  auto csr = CSR2<IDX>();
+  auto csr_nodata = csr;
+  csr_nodata.data = NDArray();
+  csr.data = aten::Range(0, csr.indices->shape[0], sizeof(IDX)*8, CTX);
+  auto r = aten::VecToIdArray(std::vector<IDX>({0, 1, 2}), sizeof(IDX)*8, CTX);
+  auto c = aten::VecToIdArray(std::vector<IDX>({1, 0, 2}), sizeof(IDX)*8, CTX);
+
+  ASSERT_TRUE(ArrayEQ<IDX>(aten::CSRGetRowData(csr, 2), aten::CSRGetRowData(csr_nodata, 2)));
+  ASSERT_TRUE(ArrayEQ<IDX>(aten::CSRGetData(csr, 0, 2), aten::CSRGetData(csr_nodata, 0, 2)));
+  ASSERT_TRUE(ArrayEQ<IDX>(aten::CSRGetData(csr, r, c), aten::CSRGetData(csr_nodata, r, c)));
+  auto arrs = aten::CSRGetDataAndIndices(csr, r, c);
+  auto arrs_nodata = aten::CSRGetDataAndIndices(csr_nodata, r, c);
+  ASSERT_TRUE(ArrayEQ<IDX>(arrs[2], arrs_nodata[2]));
+
+  auto x = aten::CSRTranspose(csr);
+  auto y = aten::CSRTranspose(csr_nodata);
+  ASSERT_TRUE(ArrayEQ<IDX>(x.indices, y.indices));
+  ASSERT_TRUE(ArrayEQ<IDX>(x.data, y.data));
+
+  auto coo = aten::CSRToCOO(csr_nodata, true);
+  auto tcoo = aten::CSRToCOO(csr, true);
+  ASSERT_TRUE(ArrayEQ<IDX>(coo.row, tcoo.row));
+  ASSERT_TRUE(ArrayEQ<IDX>(coo.col, tcoo.col));
+
+  x = aten::CSRSliceRows(csr, 1, 4);
+  y = aten::CSRSliceRows(csr_nodata, 1, 4);
+  ASSERT_TRUE(ArrayEQ<IDX>(x.data, y.data));
+  // the first rows keep the identity data
+  y = aten::CSRSliceRows(csr_nodata, 0, 2);
+  ASSERT_FALSE(aten::CSRHasData(y));
+  x = aten::CSRSliceRows(csr, r);
+  y = aten::CSRSliceRows(csr_nodata, r);
+  ASSERT_TRUE(ArrayEQ<IDX>(x.data, y.data));
+  x = aten::CSRSliceMatrix(csr, r, c);
+  y = aten::CSRSliceMatrix(csr_nodata, r, c);
+  ASSERT_TRUE(ArrayEQ<IDX>(x.data, y.data));
+}
+
+TEST(SpmatTest, TestCSRNoData) {
+  _TestCSRNoData<int32_t>();
+  _TestCSRNoData<int64_t>();
+}
+
 template <typename IDX>
 void _TestCSRHasDuplicate() {
   auto csr = CSR1<IDX>();
@@ -343,6 +527,57 @@ TEST(SpmatTest, TestCOOToCSR) {
   _TestCOOToCSR<int64_t>();
 }
 
+template <typename IDX>
+void _TestCOOToCSRLarge() {
+  // large enough to take the parallel path
+  const int64_t N = 1000, M = 300, NNZ = 200000;
+  std::vector<IDX> row(NNZ), col(NNZ);
+  for (int64_t i = 0; i < NNZ; ++i) {
+    // skewed towards row 0 and column 0
+    row[i] = (i % 3 == 0) ? 0 : (i * 7919) % N;
+    col[i] = (i % 5 == 0) ? 0 : (i * 104729) % M;
+  }
+  const int bits = sizeof(IDX) * 8;
+  aten::COOMatrix coo{N, M, aten::VecToIdArray(row, bits), aten::VecToIdArray(col, bits)};
+  auto csr = aten::COOToCSR(coo);
+  const IDX* indptr = Ptr<IDX>(csr.indptr);
+  const IDX* indices = Ptr<IDX>(csr.indices);
+  const IDX* data = Ptr<IDX>(csr.data);
+  ASSERT_EQ(indptr[0], 0);
+  ASSERT_EQ(indptr[N], NNZ);
+  for (int64_t r = 0; r < N; ++r) {
+    for (IDX j = indptr[r]; j < indptr[r + 1]; ++j) {
+      ASSERT_EQ(row[data[j]], r);
+      ASSERT_EQ(col[data[j]], indices[j]);
+      // entries of a row keep their original order
+      if (j > indptr[r]) {
+        ASSERT_LT(data[j - 1], data[j]);
+      }
+    }
+  }
+  // the transposed CSR lists the entries of a column in the order of the CSR
+  auto tcsr = aten::CSRTranspose(csr);
+  const IDX* tindptr = Ptr<IDX>(tcsr.indptr);
+  const IDX* tindices = Ptr<IDX>(tcsr.indices);
+  const IDX* tdata = Ptr<IDX>(tcsr.data);
+  ASSERT_EQ(tindptr[M], NNZ);
+  for (int64_t c = 0; c < M; ++c) {
+    for (IDX j = tindptr[c]; j < tindptr[c + 1]; ++j) {
+      ASSERT_EQ(col[tdata[j]], c);
+      ASSERT_EQ(row[tdata[j]], tindices[j]);
+      if (j > tindptr[c]) {
+        ASSERT_TRUE(tindices[j - 1] < tindices[j]
+                    || (tindices[j - 1] == tindices[j] && tdata[j - 1] < tdata[j]));
+      }
+    }
+  }
+}
+
+TEST(SpmatTest, TestCOOToCSRLarge) {
+  _TestCOOToCSRLarge<int32_t>();
+  _TestCOOToCSRLarge<int64_t>();
+}
+
 template <typename IDX>
 void _TestCOOHasDuplicate() {
   auto csr = COO1<IDX>();
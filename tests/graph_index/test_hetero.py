@@ -352,6 +352,39 @@ def test_subgraph():
     g = gen_from_csr()
     _test_g(g)
 
+def test_hetero_copy_reduce():
+    from dgl import kernel
+    def _test_g(g):
+        x0 = np.random.randn(5, 2).astype(np.float32)
+        x2 = np.random.randn(3, 2).astype(np.float32)
+        w = nd.array(np.array([2., 0., 3.], dtype=np.float32))
+        # copy src, sum into ntype 1 over relation 0 and 2
+        out = nd.empty((2, 2))
+        kernel.hetero_copy_reduce('sum', g, 1, 0,
+                                  [nd.array(x0), None, nd.array(x2)], out, w)
+        expected = np.stack([2 * x0[0:4].sum(0), 3 * x2.sum(0)])
+        assert np.allclose(out.asnumpy(), expected)
+        # copy edge, max into ntype 1 without weights
+        e0 = np.random.randn(4, 2).astype(np.float32)
+        e2 = np.random.randn(3, 2).astype(np.float32)
+        out = nd.empty((2, 2))
+        kernel.hetero_copy_reduce('max', g, 1, 2,
+                                  [nd.array(e0), None, nd.array(e2)], out)
+        expected = np.stack([e0.max(0), e2.max(0)])
+        assert np.allclose(out.asnumpy(), expected)
+        # copy src, mean into ntype 1 divides by the in-degree over the relations
+        out = nd.empty((2, 2))
+        kernel.hetero_copy_reduce('mean', g, 1, 0,
+                                  [nd.array(x0), None, nd.array(x2)], out, w)
+        expected = np.stack([2 * x0[0:4].sum(0) / 4, 3 * x2.sum(0) / 3])
+        assert np.allclose(out.asnumpy(), expected)
+
+    g = gen_from_coo()
+    _test_g(g)
+    g = gen_from_csr()
+    _test_g(g)
+
 if __name__ == '__main__':
     test_query()
     test_subgraph()
+    test_hetero_copy_reduce()